@@ -98,6 +98,14 @@ Compound =
 	--!
 
 	path,
+
+	--!
+	--! Holds `path` in the form suitable for building file names: forward
+	--! slashes are replaced with underscores (e.g. ``sys_win_WaitableTimer``) and operator
+	--! signs are stripped (e.g. ``foo/operator+=`` becomes ``foo_operator``).
+	--!
+
+	fileNamePath,
 	importArray,
 
 	--! Holds a `Description` table with the brief description of the compound.
@@ -109,6 +117,17 @@ Compound =
 
 	detailedDescription,
 
+	--[[!
+		Holds an array of `Member` tables for members referencing this
+		compound -- in their types, parameters, initializers or in the
+		descriptions (deferred descriptions which have not been loaded yet are
+		not scanned).
+
+		This field is only set if there are such members.
+	]]
+
+	usedByArray,
+
 	--! Holds a `Location` table describing the place of declaration.
 
 	location,
@@ -163,6 +182,19 @@ Class =
 
 	templateSpecParamArray,
 	baseTypeArray,
+
+	--[[!
+		Holds an array of `Compound` tables with all the direct and indirect
+		base types of the compound. Each base type is listed once, after its
+		own base types (i.e., in the depth-first order). Base types which are
+		templates or imported (``compoundKind`` is ``<undefined>``) are not
+		included.
+
+		The closure is computed once per compound and shared, so frames don't
+		have to walk the hierarchy recursively to collect inherited members.
+	]]
+
+	baseTypeClosureArray,
 	baseTypeProtectionArray,
 	derivedTypeArray,
 }
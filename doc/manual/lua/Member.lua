@@ -149,6 +149,14 @@ Member =
 
 	path,
 
+	--!
+	--! Holds `path` in the form suitable for building file names: forward
+	--! slashes are replaced with underscores (e.g. ``io_NetworkAdapterType``) and operator
+	--! signs are stripped (e.g. ``foo/operator+=`` becomes ``foo_operator``).
+	--!
+
+	fileNamePath,
+
 	--! Holds a `Description` table with the brief description of the member.
 
 	briefDescription,
@@ -161,6 +169,17 @@ Member =
 
 	inBodyDescription,
 
+	--[[!
+		Holds an array of `Member` tables for other members referencing this
+		member -- in their types, parameters, initializers or in the
+		descriptions (deferred descriptions which have not been loaded yet are
+		not scanned).
+
+		This field is only set if there are such members.
+	]]
+
+	usedByArray,
+
 	--! Holds a `Location` table describing the place of declaration.
 
 	location,
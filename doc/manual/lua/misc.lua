@@ -143,6 +143,10 @@ Description =
 	--!
 	--! Type of each element of the array is `DocBlock`.
 	--!
+	--! When ``XML_DEFER_DESCRIPTIONS`` is set, this array is built the first
+	--! time it's accessed. When ``XML_STREAMING`` is set, it's also dropped
+	--! after each generated file and re-built on the next access.
+	--!
 
 	docBlockList,
 }
@@ -97,6 +97,22 @@ function generateFile(targetFileName, frameFileName, ...) end
 		local extraArg = argArray [1]
 ]]
 
+--!
+--! Adds an entry mapping the qualified name ``name`` to the anchor ``target``
+--! to the cref-database. If ``name`` is already in the database, the previous
+--! target is replaced.
+--!
+
+function addCrefDbEntry(name, target) end
+
+--!
+--! Writes the cref-database accumulated so far with ``addCrefDbEntry`` to
+--! the binary file ``fileName`` (relative to the output directory) and
+--! resets the database.
+--!
+
+function writeCrefDb(fileName) end
+
 --------------------------------------------------------------------------------
 
 --! @}
@@ -828,6 +828,26 @@ end
 
 -- base compound is an artificial compound holding all inherited members
 
+function addBaseTypeItems(baseCompound, baseType)
+	prepareCompound(baseType)
+
+	concatenateTables(baseCompound.typedefArray, baseType.typedefArray)
+	concatenateTables(baseCompound.enumArray, baseType.enumArray)
+	concatenateTables(baseCompound.structArray, baseType.structArray)
+	concatenateTables(baseCompound.unionArray, baseType.unionArray)
+	concatenateTables(baseCompound.interfaceArray, baseType.interfaceArray)
+	concatenateTables(baseCompound.protocolArray, baseType.protocolArray)
+	concatenateTables(baseCompound.exceptionArray, baseType.exceptionArray)
+	concatenateTables(baseCompound.classArray, baseType.classArray)
+	concatenateTables(baseCompound.singletonArray, baseType.singletonArray)
+	concatenateTables(baseCompound.serviceArray, baseType.serviceArray)
+	concatenateTables(baseCompound.variableArray, baseType.variableArray)
+	concatenateTables(baseCompound.propertyArray, baseType.propertyArray)
+	concatenateTables(baseCompound.eventArray, baseType.eventArray)
+	concatenateTables(baseCompound.functionArray, baseType.functionArray)
+	concatenateTables(baseCompound.aliasArray, baseType.aliasArray)
+end
+
 function addToBaseCompound(baseCompound, baseTypeArray)
 	for i = 1, #baseTypeArray do
 		local baseType = baseTypeArray[i]
@@ -844,21 +864,7 @@ function addToBaseCompound(baseCompound, baseTypeArray)
 				addToBaseCompound(baseCompound, baseType.baseTypeArray)
 			end
 
-			concatenateTables(baseCompound.typedefArray, baseType.typedefArray)
-			concatenateTables(baseCompound.enumArray, baseType.enumArray)
-			concatenateTables(baseCompound.structArray, baseType.structArray)
-			concatenateTables(baseCompound.unionArray, baseType.unionArray)
-			concatenateTables(baseCompound.interfaceArray, baseType.interfaceArray)
-			concatenateTables(baseCompound.protocolArray, baseType.protocolArray)
-			concatenateTables(baseCompound.exceptionArray, baseType.exceptionArray)
-			concatenateTables(baseCompound.classArray, baseType.classArray)
-			concatenateTables(baseCompound.singletonArray, baseType.singletonArray)
-			concatenateTables(baseCompound.serviceArray, baseType.serviceArray)
-			concatenateTables(baseCompound.variableArray, baseType.variableArray)
-			concatenateTables(baseCompound.propertyArray, baseType.propertyArray)
-			concatenateTables(baseCompound.eventArray, baseType.eventArray)
-			concatenateTables(baseCompound.functionArray, baseType.functionArray)
-			concatenateTables(baseCompound.aliasArray, baseType.aliasArray)
+			addBaseTypeItems(baseCompound, baseType)
 		end
 	end
 end
@@ -893,7 +899,20 @@ end
 function createBaseCompound(compound)
 	local baseCompound = createPseudoCompound("base-compound")
 	baseCompound.isBaseCompound = true
-	addToBaseCompound(baseCompound, compound.baseTypeArray)
+
+	-- the transitive closure of base types is precomputed by doxyrest (already
+	-- de-duplicated and in the depth-first order); fall back to walking the
+	-- hierarchy for compounds not coming from doxyrest
+
+	local closure = compound.baseTypeClosureArray
+	if closure then
+		for i = 1, #closure do
+			addBaseTypeItems(baseCompound, closure[i])
+		end
+	else
+		addToBaseCompound(baseCompound, compound.baseTypeArray)
+	end
+
 	baseCompound.hasItems = hasCompoundItems(baseCompound)
 	handleCompoundProtection(baseCompound)
 
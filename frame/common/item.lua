@@ -55,6 +55,8 @@ function getItemFileName(item, suffix)
 
 	if item.compoundKind == "group" then
 		s = s .. item.name
+	elseif item.fileNamePath then
+		s = s .. item.fileNamePath
 	else
 		local path = string.gsub(item.path, "/operator[%s%p]+$", "/operator")
 		s = s .. string.gsub(path, "/", "_")
@@ -69,6 +71,47 @@ function getItemFileName(item, suffix)
 	return s .. suffix
 end
 
+-- file names of colliding items are numbered in the order of the first
+-- getItemFileName call; naming all the items up front makes the names
+-- independent of the order (and the subset) of generated files, which is
+-- what --shard relies upon
+
+g_fileItemArrayNameList = {
+	"groupArray",
+	"namespaceArray",
+	"enumArray",
+	"structArray",
+	"unionArray",
+	"interfaceArray",
+	"protocolArray",
+	"exceptionArray",
+	"classArray",
+	"singletonArray",
+	"serviceArray",
+	"subPageArray",
+}
+
+function assignNestedItemFileNames(item, visitedMap)
+	for i = 1, #g_fileItemArrayNameList do
+		local itemArray = item[g_fileItemArrayNameList[i]]
+		if itemArray then
+			assignItemFileNames(itemArray, visitedMap)
+		end
+	end
+end
+
+function assignItemFileNames(itemArray, visitedMap)
+	for i = 1, #itemArray do
+		local item = itemArray[i]
+
+		if not visitedMap[item.id] then
+			visitedMap[item.id] = true
+			getItemFileName(item)
+			assignNestedItemFileNames(item, visitedMap)
+		end
+	end
+end
+
 function getItemRefTargetString(item)
 	if string.match(item.name, ":$") then -- Objective C methods (simple handling for now)
 		return ".. _doxid-" .. item.id .. ":\n"
@@ -50,6 +50,116 @@ FRAME_FILE = nil
 
 INPUT_FILE = nil
 
+--[[!
+	Specify how Doxygen XML files are read:
+
+		* ``"mmap"`` -- each XML file is memory-mapped and fed to the XML
+		  parser directly from the mapping, ``XML_BLOCK_SIZE`` bytes at a time;
+		  the mapping is dropped as soon as the file is parsed;
+		* ``"read"`` -- each XML file is read through an intermediate buffer
+		  of ``XML_BLOCK_SIZE`` bytes.
+
+	``"mmap"`` is only available on POSIX systems; elsewhere, ``"read"`` is
+	always used. Any other value is an error.
+
+	In ``"mmap"`` mode (and when reading from an XML archive), the contents of
+	compound-level elements which Doxyrest ignores (``programlisting``,
+	``listofallmembers``, ``incdepgraph``, ``invincdepgraph``,
+	``collaborationgraph``, ``inheritancegraph``) are skipped over as raw bytes
+	without passing them through the XML parser.
+]]
+
+XML_INPUT_MODE = "mmap"
+
+--!
+--! The size of a slice of XML passed to the XML parser at once. If unset, 1M
+--! will be used.
+--!
+
+XML_BLOCK_SIZE = nil
+
+--[[!
+	Set ``XML_PRESIZE_HANDLES`` to ``true`` to count the ids in ``index.xml``
+	with an extra quick pass before the main parse, and pre-size the id table
+	to that count. This avoids re-hashing the id table while compounds are
+	parsed, but costs one more pass over ``index.xml`` -- whether it pays off
+	depends on the size of the project, so it's off by default.
+]]
+
+XML_PRESIZE_HANDLES = false
+
+--[[!
+	By default, the tree of documentation blocks is built for every brief,
+	detailed and in-body description right when Doxygen XML is parsed -- even
+	for items which are later filtered out and never rendered.
+
+	Set ``XML_DEFER_DESCRIPTIONS`` to ``true`` to only record the location of
+	each description in its XML file during the parsing stage; a description
+	will be parsed the first time a frame accesses its ``docBlockList``. This
+	makes parsing time and memory usage proportional to the amount of
+	documentation which is actually rendered. The targets of references inside
+	deferred descriptions are still recorded, so ``usedByArray`` stays the
+	same either way.
+
+	The XML files (or the XML archive) must not change while ``doxyrest`` is
+	running.
+]]
+
+XML_DEFER_DESCRIPTIONS = false
+
+--[[!
+	Set ``XML_STREAMING`` to ``true`` to keep memory usage bounded on very
+	large inputs. Only a skeleton of the documentation model (compounds and
+	members with their names, ids, kinds, types, parameters and parents) is
+	built up front; descriptions are parsed when a frame first accesses them
+	(like with ``XML_DEFER_DESCRIPTIONS``, which this setting implies) and are
+	freed -- both the C++ doc block trees and the exported Lua tables -- each
+	time a generated file (top-level or nested) is written. Peak memory usage
+	is, roughly, the size of the skeleton plus the documentation accessed
+	between two consecutive written files.
+
+	A description accessed from several files gets parsed again for each one
+	of them. Can't be used with multiple configurations (``-c``) in one run.
+]]
+
+XML_STREAMING = false
+
+--[[!
+	Garbage collector mode for the Lua state holding the exported tables and
+	running the frames:
+
+		* ``"incremental"`` -- the default Lua collector;
+		* ``"generational"`` -- usually cheaper when most of the heap consists
+		  of long-lived objects (which is exactly the case with the exported
+		  tables); only available with Lua 5.4, otherwise ``"incremental"`` is
+		  used and a warning is issued.
+
+	Like any other setting here, GC settings can be overridden from the
+	command line, e.g.: ``-D LUA_GC_MODE=generational``.
+]]
+
+LUA_GC_MODE = "incremental"
+
+--!
+--! Pause and step multiplier of the incremental collector (see the Lua
+--! reference manual, section "Garbage Collection"). If ``nil``, Lua defaults
+--! are used. Not used in the generational mode.
+--!
+
+LUA_GC_PAUSE = nil
+LUA_GC_STEP_MULTIPLIER = nil
+
+--[[!
+	Set to ``true`` to stop the Lua garbage collector while the documentation
+	model is being exported into Lua tables. Nearly all the allocations made
+	at this stage stay alive until the end, so collection cycles are mostly
+	wasted. The collector is restarted when rendering of frames begins.
+
+	Use ``--stats`` to see the size of the Lua heap at phase boundaries.
+]]
+
+LUA_GC_STOP_DURING_EXPORT = false
+
 --!
 --! The output master (index) reStructuredText file. Usually, the index frame
 --! also generates auxillary files -- they will be placed next to the master
@@ -60,6 +170,34 @@ INPUT_FILE = nil
 
 OUTPUT_FILE = nil
 
+--!
+--! When non-``nil``, all the generated files (the master file, auxillary
+--! files, ``crefdb.bin``) are packed into a single uncompressed ``.tar``
+--! archive with this name instead of being written to the file system one by
+--! one; paths inside the archive are relative to the directory of the master
+--! file. This greatly reduces the overhead on network file systems and in
+--! containers. The command line option ``-a`` *overrides* this value.
+--!
+
+OUTPUT_ARCHIVE = nil
+
+--!
+--! When non-``nil``, Doxyrest also writes a prebuilt search index for
+--! client-side symbol lookup into this directory (relative to the master
+--! file): ``index.json`` (the manifest) and a number of small shard files,
+--! each holding the compounds, members and enum values whose names begin with
+--! the same two characters, sorted by name. One-character queries are served
+--! by *short* shards holding the first 100 names for each first character.
+--! ``sphinx/js/doxyrest-search.js`` fetches only the one shard matching a
+--! query. Matching is case-insensitive for ASCII letters only; non-ASCII
+--! characters are matched exactly. Sphinx does not copy ``.json``
+--! files from the source tree, so list a directory containing it in
+--! ``html_extra_path`` in ``conf.py``. The index is not written in ``--plan``, ``--shard`` and
+--! ``--merge`` runs.
+--!
+
+SEARCH_INDEX_DIR = nil
+
 --!
 --! File with project-specific reStructuredText definitions. When non``nil``,
 --! this file will be included at the top of every generated ``.rst`` file.
@@ -128,6 +266,9 @@ GLOBAL_AUX_COMPOUND_ID = "group_global"
 	pseudo-members. If it is set to ``nil`` or an empty string, Doxyrest
 	will not attempt to convert any members to footnotes.
 
+	Members duplicated inside groups are normally parsed as id references
+	only; those with this prefix are parsed in full.
+
 	\sa :ref:`footnotes`
 ]]
 
@@ -212,10 +353,17 @@ SECTION_TO_RUBRIC = false
 HEADING_TO_RUBRIC = false
 
 --[[!
-	By default, Doxyrest frames build a Python dictionary to be used later on by
+	By default, Doxyrest frames build a cref-database to be used later on by
 	the ``:cref:`` (code-reference) role. This database maps language-specific
 	qualified names of items to their IDs.
 
+	The database is written as ``crefdb.bin`` -- a compact binary table sorted
+	by name. The Sphinx extension memory-maps it and looks names up with a
+	binary search on demand, so nothing is parsed or loaded upfront. The
+	extension finds ``crefdb.bin`` files under the Sphinx source directory;
+	to use another one, set ``doxyrest_cref_file`` in ``conf.py`` (a path
+	relative to ``conf.py``).
+
 	This, together with setting the Sphinx ``default_role`` to ``cref``, allows
 	to conveniently reference items from Doxy-comments or regular ``.rst`` files
 	as such:
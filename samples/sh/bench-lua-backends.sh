@@ -0,0 +1,94 @@
+#!/bin/bash
+#...............................................................................
+#
+#  This file is part of the Doxyrest toolkit.
+#
+#  Doxyrest is distributed under the MIT license.
+#  For details see accompanying license.txt file,
+#  the public copy of which is also available at:
+#  http://tibbo.com/downloads/archive/doxyrest/license.txt
+#
+#...............................................................................
+#
+#  Compares two doxyrest builds (e.g. the reference Lua one and the LuaJIT one,
+#  see DOXYREST_USE_LUAJIT) on the bundled samples: reports the best wall-clock
+#  time of each build and checks that the generated .rst files are identical.
+#
+#  Usage: bench-lua-backends.sh <doxyrest-1> <doxyrest-2> [<run-count>]
+#
+
+set -e
+
+if [ $# -lt 2 ]; then
+	echo "Usage: $0 <doxyrest-1> <doxyrest-2> [<run-count>]"
+	exit 1
+fi
+
+EXE_1=$1
+EXE_2=$2
+RUN_COUNT=${3:-3}
+
+ROOT_DIR=$(cd $(dirname $0)/../.. && pwd)
+TMP_DIR=$(mktemp -d)
+trap "rm -rf $TMP_DIR" EXIT
+
+echo "1: $($EXE_1 --version)"
+echo "2: $($EXE_2 --version)"
+echo
+
+# prints the best (minimal) time in milliseconds out of RUN_COUNT runs
+
+benchmark()
+{
+	local exe=$1
+	local archive=$2
+	local config=$3
+	local outDir=$4
+	local best=
+
+	for ((i = 0; i < RUN_COUNT; i++)); do
+		rm -rf $outDir
+		mkdir -p $outDir
+
+		local start=$(date +%s%N)
+
+		$exe $archive \
+			-c $config \
+			-o $outDir/index.rst \
+			-F $ROOT_DIR/frame/cfamily \
+			-F $ROOT_DIR/frame/common \
+			-f index.rst.in \
+			> /dev/null
+
+		local time=$((($(date +%s%N) - start) / 1000000))
+
+		if [ -z "$best" ] || [ $time -lt $best ]; then
+			best=$time
+		fi
+	done
+
+	echo $best
+}
+
+printf "%-16s %10s %10s %8s  %s\n" sample "1, ms" "2, ms" speedup output
+
+for archive in $ROOT_DIR/samples/*/xml*.tar.xz; do
+	sampleDir=$(dirname $archive)
+	sample=$(basename $sampleDir)
+
+	time1=$(benchmark $EXE_1 $archive $sampleDir/doxyrest-config.lua $TMP_DIR/$sample-1)
+	time2=$(benchmark $EXE_2 $archive $sampleDir/doxyrest-config.lua $TMP_DIR/$sample-2)
+
+	if diff -r -q $TMP_DIR/$sample-1 $TMP_DIR/$sample-2 > /dev/null; then
+		output=identical
+	else
+		output=DIFFERENT
+	fi
+
+	printf "%-16s %10d %10d %8s  %s\n" \
+		$sample \
+		$time1 \
+		$time2 \
+		$(awk "BEGIN { printf \"%.2fx\", $time1 / ($time2 ? $time2 : 1) }") \
+		$output
+done
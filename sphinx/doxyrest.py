@@ -11,12 +11,15 @@
 
 import os
 import re
+import mmap
+import struct
 import warnings
 from docutils import nodes
 from docutils.parsers.rst import Directive, directives
 from docutils.transforms import Transform
 from docutils.statemachine import StringList, string2lines
 from sphinx import roles, addnodes, config
+from sphinx.errors import ConfigError
 from sphinx.io import SphinxBaseFileInput, SphinxRSTFileInput
 from sphinx.directives.other import Include
 
@@ -27,11 +30,84 @@ from sphinx.directives.other import Include
 
 this_dir = os.path.dirname(os.path.realpath(__file__))
 crefdb = {}
+crefdb_bin_list = []
+
+
+class CrefDb:
+    # see src/CrefDb.h for the layout of crefdb.bin
+
+    signature = b'DXRCRFDB'
+    hdr_format = '<8sII'
+    entry_format = '<IIII'
+    hdr_size = struct.calcsize(hdr_format)
+    entry_size = struct.calcsize(entry_format)
+
+    def __init__(self, path):
+        self.path = path
+        self.map = None
+        self.count = 0
+
+    def open(self):
+        if self.map is not None:
+            return
+
+        self.map = b''  # don't retry on failure
+
+        with open(self.path, 'rb') as f:
+            size = os.fstat(f.fileno()).st_size
+            if size < CrefDb.hdr_size:
+                warnings.warn('invalid cref database: ' + self.path, Warning, 2)
+                return
+
+            map = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+
+        signature, version, count = struct.unpack_from(CrefDb.hdr_format, map, 0)
+        if signature != CrefDb.signature or version != 1:
+            warnings.warn('invalid cref database: ' + self.path, Warning, 2)
+            map.close()
+            return
+
+        self.map = map
+        self.count = count
+
+    def get_entry(self, i):
+        return struct.unpack_from(
+            CrefDb.entry_format,
+            self.map,
+            CrefDb.hdr_size + i * CrefDb.entry_size
+            )
+
+    def get(self, text):
+        self.open()
+
+        key = text.encode('utf-8')
+        lo = 0
+        hi = self.count
+
+        while lo < hi:
+            mid = (lo + hi) // 2
+            name_offset, name_length, target_offset, target_length = self.get_entry(mid)
+            name = self.map[name_offset:name_offset + name_length]
+            if name == key:
+                return self.map[target_offset:target_offset + target_length].decode('utf-8')
+            elif name < key:
+                lo = mid + 1
+            else:
+                hi = mid
+
+        return None
+
 
 def get_cref_target(text):
     if text in crefdb:
         return crefdb[text]
 
+    for db in reversed(crefdb_bin_list):  # later databases win
+        target = db.get(text)
+        if target is not None:
+            crefdb[text] = target
+            return target
+
     warnings.warn('target not found for cref: ' + text, Warning, 2)
     return None
 
@@ -330,11 +406,13 @@ class TabAwareSphinxRSTFileInput(SphinxRSTFileInput):
 def on_builder_inited(app):
     app.config.html_static_path += [
         this_dir + '/css/doxyrest-pygments.css',
-        this_dir + '/js/target-highlight.js'
+        this_dir + '/js/target-highlight.js',
+        this_dir + '/js/doxyrest-search.js'
     ]
 
     app.add_stylesheet('doxyrest-pygments.css')
     app.add_javascript('target-highlight.js')
+    app.add_javascript('doxyrest-search.js')
 
     supported_themes = {
         'sphinx_rtd_theme',
@@ -346,15 +424,34 @@ def on_builder_inited(app):
         app.config.html_static_path += [this_dir + '/css/' + css_file];
         app.add_stylesheet(css_file);
 
+    if app.config.doxyrest_cref_file:
+        # relative to conf.py, like other Sphinx paths
+
+        crefdb_path = os.path.join(app.confdir, app.config.doxyrest_cref_file)
+        if not os.path.isfile(crefdb_path):
+            raise ConfigError('doxyrest_cref_file not found: ' + crefdb_path)
+
+        crefdb_bin_list.append(CrefDb(crefdb_path))
+        return
+
+    global crefdb
+
     for basedir, dirnames, filenames in os.walk(app.srcdir):
-        if 'crefdb.py' in filenames:
+        if 'crefdb.bin' in filenames:
+            # opened lazily on the first lookup
+
+            crefdb_path = os.path.join(basedir, 'crefdb.bin')
+            crefdb_bin_list.append(CrefDb(crefdb_path))
+
+        elif 'crefdb.py' in filenames:
+            # legacy dictionary written by older frames
+
             crefdb_path = os.path.join(basedir, 'crefdb.py')
             src = open(crefdb_path).read()
             ns = {}
             exec(src, ns)
             new_crefdb = ns['crefdb']
             if isinstance(new_crefdb, dict):
-                global crefdb
                 crefdb.update(new_crefdb)
 
 #...............................................................................
@@ -0,0 +1,179 @@
+//..............................................................................
+//
+//  This file is part of the Doxyrest toolkit.
+//
+//  Doxyrest is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/doxyrest/license.txt
+//
+//..............................................................................
+
+// client side of the prebuilt search index (SEARCH_INDEX_DIR in
+// doxyrest-config.lua); usage:
+//
+//   DoxyrestSearch.init("_static/search/", ".html");
+//   DoxyrestSearch.find("getfoo", 20, function (matches) { ... });
+
+var DoxyrestSearch = (function () {
+
+var g_baseUrl = "";
+var g_pageSuffix = ".html";
+var g_manifest = null;
+var g_shardMap = {}; // shard file name -> array of entries (or a pending callback list)
+
+// same as docutils.nodes.make_id -- that's what labels become in HTML
+
+function makeAnchorId(id) {
+	return id.toLowerCase().replace(/[^a-z0-9]+/g, "-").replace(/^-+|-+$/g, "");
+}
+
+// same as getSearchKey in SearchIndex.cpp: ASCII letters are lower-cased, '%'
+// and non-ASCII characters are percent-encoded as UTF-8 (with lower-case hex
+// digits) -- keys are pure ASCII, so they compare the same way here and in C++
+
+function encodeSearchKeyChars(s) {
+	return encodeURIComponent(s).toLowerCase();
+}
+
+function getSearchKey(name) {
+	var key = name.replace(/[A-Z]+/g, function (s) { return s.toLowerCase(); });
+
+	try {
+		return key.replace(/[^\x00-\x24\x26-\x7f]+/g, encodeSearchKeyChars);
+	} catch (e) { // unpaired surrogates
+		return "";
+	}
+}
+
+function getShardName(key, prefixLength) {
+	var name = "";
+	var length = Math.min(key.length, prefixLength);
+
+	for (var i = 0; i < length; i++) {
+		var c = key.charAt(i);
+		name += /[a-z0-9]/.test(c) ? c : "_";
+	}
+
+	return name;
+}
+
+function loadJson(url, onLoaded) {
+	$.ajax({
+		url: url,
+		dataType: "json",
+		success: onLoaded,
+		error: function () { onLoaded(null); }
+	});
+}
+
+function loadShard(name, onLoaded) {
+	var shard = g_shardMap[name];
+	if (shard && shard.isPending) {
+		shard.callbackList.push(onLoaded);
+		return;
+	}
+
+	if (shard) {
+		onLoaded(shard);
+		return;
+	}
+
+	shard = { isPending: true, callbackList: [onLoaded] };
+	g_shardMap[name] = shard;
+
+	loadJson(g_baseUrl + name + ".json", function (entryArray) {
+		entryArray = entryArray || [];
+		g_shardMap[name] = entryArray;
+
+		for (var i = 0; i < shard.callbackList.length; i++)
+			shard.callbackList[i](entryArray);
+	});
+}
+
+// entries are sorted by key; find the first one not less than the prefix
+
+function findLowerBound(entryArray, prefix) {
+	var lo = 0;
+	var hi = entryArray.length;
+
+	while (lo < hi) {
+		var mid = (lo + hi) >> 1;
+		if (entryArray[mid][0] < prefix)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+function findInShard(entryArray, prefix, maxCount) {
+	var matchArray = [];
+
+	var i = findLowerBound(entryArray, prefix);
+	for (; i < entryArray.length && matchArray.length < maxCount; i++) {
+		var entry = entryArray[i];
+		if (entry[0].lastIndexOf(prefix, 0) != 0)
+			break;
+
+		matchArray.push({
+			name: entry[1],
+			kind: entry[2],
+			url: entry[3] ? entry[3] + g_pageSuffix + "#" + makeAnchorId("doxid-" + entry[4]) : null,
+			brief: entry[5]
+		});
+	}
+
+	return matchArray;
+}
+
+// a query is answered by a single shard: the regular one for its prefix or,
+// if the query is shorter than the prefix, the short shard (which holds only
+// the first shortShardLimit entries -- enough for a list of suggestions)
+
+function getShardFileName(prefix) {
+	var name = getShardName(prefix, g_manifest.prefixLength);
+
+	if (name.length >= g_manifest.prefixLength)
+		return g_manifest.shards.indexOf(name) != -1 ? name : null;
+
+	return g_manifest.shortShards.indexOf(name) != -1 ? name + ".short" : null;
+}
+
+function find(query, maxCount, onFound) {
+	var prefix = g_manifest ? getSearchKey($.trim(query)) : "";
+	var fileName = prefix ? getShardFileName(prefix) : null;
+
+	if (!fileName) {
+		onFound([]);
+		return;
+	}
+
+	loadShard(fileName, function (entryArray) {
+		onFound(findInShard(entryArray, prefix, maxCount));
+	});
+}
+
+function init(baseUrl, pageSuffix, onReady) {
+	g_baseUrl = baseUrl;
+	if (pageSuffix !== undefined)
+		g_pageSuffix = pageSuffix;
+
+	loadJson(g_baseUrl + "index.json", function (manifest) {
+		if (manifest && manifest.version == 2)
+			g_manifest = manifest;
+
+		if (onReady)
+			onReady(g_manifest != null);
+	});
+}
+
+return {
+	init: init,
+	find: find
+};
+
+} ());
+
+//..............................................................................
@@ -0,0 +1,301 @@
+//..............................................................................
+//
+//  This file is part of the Doxyrest toolkit.
+//
+//  Doxyrest is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/doxyrest/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "BatchRunner.h"
+#include "Session.h"
+
+//..............................................................................
+
+inline
+bool
+isBatchProjectMoreCostly(
+	const BatchProject* project1,
+	const BatchProject* project2
+	)
+{
+	return project1->m_cost > project2->m_cost;
+}
+
+// index.xml lists every compound and member, so its size is a fair estimate of
+// the amount of work (and so is the size of an archive)
+
+static
+uint64_t
+estimateProjectCost(const sl::StringRef& inputFileName)
+{
+	io::File file;
+	bool result = file.open(inputFileName, io::FileFlag_ReadOnly);
+	return result ? file.getSize() : 0;
+}
+
+static
+bool
+isSpace(char c)
+{
+	return c == ' ' || c == '\t';
+}
+
+//..............................................................................
+
+size_t
+BatchRunner::getFailedProjectCount()
+{
+	size_t count = 0;
+
+	sl::ConstIterator<BatchProject> it = m_projectList.getHead();
+	for (; it; it++)
+		if (!it->m_result)
+			count++;
+
+	return count;
+}
+
+void
+BatchRunner::addProject(
+	const sl::StringRef& inputFileName,
+	const sl::StringRef& configFileName,
+	const sl::StringRef& outputFileName
+	)
+{
+	BatchProject* project = AXL_MEM_NEW(BatchProject);
+	project->m_inputFileName = inputFileName;
+	project->m_configFileName = configFileName != "-" ? configFileName : sl::StringRef();
+	project->m_outputFileName = outputFileName != "-" ? outputFileName : sl::StringRef();
+	project->m_cost = estimateProjectCost(inputFileName);
+	m_projectList.insertTail(project);
+}
+
+bool
+BatchRunner::readProjectList(const sl::StringRef& fileName)
+{
+	io::File file;
+	bool result = file.open(fileName, io::FileFlag_ReadOnly);
+	if (!result)
+		return false;
+
+	size_t size = (size_t)file.getSize();
+
+	sl::Array<char> buffer;
+	buffer.setCount(size);
+	if (file.read(buffer.p(), size) != size)
+	{
+		err::setFormatStringError("error reading '%s'", fileName.sz());
+		return false;
+	}
+
+	const char* p = buffer.cp();
+	const char* end = p + size;
+
+	for (size_t lineNumber = 1; p < end; lineNumber++)
+	{
+		const char* eol = (const char*)memchr(p, '\n', end - p);
+		if (!eol)
+			eol = end;
+
+		const char* lineEnd = eol > p && eol[-1] == '\r' ? eol - 1 : eol;
+		const char* lineBegin = p;
+		p = eol + 1;
+
+		sl::StringRef fieldTable[3];
+		size_t fieldCount = 0;
+
+		const char* p2 = lineBegin;
+		for (;;)
+		{
+			while (p2 < lineEnd && isSpace(*p2))
+				p2++;
+
+			if (p2 >= lineEnd || *p2 == '#')
+				break;
+
+			if (fieldCount >= countof(fieldTable))
+			{
+				err::setFormatStringError("%s(%d): too many fields in a project record", fileName.sz(), (int)lineNumber);
+				return false;
+			}
+
+			const char* fieldBegin = p2;
+			while (p2 < lineEnd && !isSpace(*p2))
+				p2++;
+
+			fieldTable[fieldCount++] = sl::StringRef(fieldBegin, p2 - fieldBegin);
+		}
+
+		if (fieldCount)
+			addProject(fieldTable[0], fieldTable[1], fieldTable[2]);
+	}
+
+	if (m_projectList.isEmpty())
+	{
+		err::setFormatStringError("'%s' contains no projects", fileName.sz());
+		return false;
+	}
+
+	return true;
+}
+
+bool
+BatchRunner::run(
+	const CmdLine* cmdLine,
+	size_t threadCount
+	)
+{
+	m_cmdLine = cmdLine;
+
+	size_t count = m_projectList.getCount();
+	m_queue.setCount(count);
+
+	sl::Iterator<BatchProject> it = m_projectList.getHead();
+	for (size_t i = 0; it; it++, i++)
+		m_queue[i] = *it;
+
+	// longest processing time first: the big projects start right away and the
+	// small ones fill the gaps at the end
+
+	std::stable_sort(m_queue.p(), m_queue.p() + count, isBatchProjectMoreCostly);
+	m_nextProjectIdx = 0;
+
+	m_spareThreadCount = 0;
+
+	if (threadCount > count)
+	{
+		m_spareThreadCount = threadCount - count;
+		threadCount = count;
+	}
+
+	sl::Array<WorkerThread*> threadArray;
+	threadArray.setCount(threadCount);
+
+	for (size_t i = 1; i < threadCount; i++)
+	{
+		WorkerThread* thread = AXL_MEM_NEW(WorkerThread);
+		thread->m_runner = this;
+		thread->start();
+		threadArray[i] = thread;
+	}
+
+	runWorker(); // the calling thread is a worker, too
+
+	for (size_t i = 1; i < threadCount; i++)
+	{
+		threadArray[i]->waitAndClose();
+		AXL_MEM_DELETE(threadArray[i]);
+	}
+
+	it = m_projectList.getHead();
+	for (; it; it++)
+		if (!it->m_result)
+		{
+			err::setFormatStringError("%s: %s", it->m_inputFileName.sz(), it->m_errorString.sz());
+			return false;
+		}
+
+	return true;
+}
+
+BatchProject*
+BatchRunner::getNextProject(size_t* threadCount)
+{
+	m_lock.lock();
+
+	BatchProject* project = NULL;
+	size_t remainingCount = m_queue.getCount() - m_nextProjectIdx;
+
+	if (remainingCount)
+	{
+		project = m_queue[m_nextProjectIdx++];
+
+		// spread the spare threads evenly over the projects yet to start
+
+		size_t extraCount = m_spareThreadCount / remainingCount;
+		m_spareThreadCount -= extraCount;
+		*threadCount = 1 + extraCount;
+	}
+
+	m_lock.unlock();
+	return project;
+}
+
+void
+BatchRunner::runWorker()
+{
+	for (;;)
+	{
+		size_t threadCount;
+		BatchProject* project = getNextProject(&threadCount);
+		if (!project)
+			break;
+
+		project->m_result = runProject(project, threadCount);
+		if (!project->m_result)
+		{
+			project->m_errorString = err::getLastErrorDescription(); // errors are thread-local
+			fprintf(stderr, "%s: error: %s\n", project->m_inputFileName.sz(), project->m_errorString.sz());
+		}
+		else
+		{
+			printf("%s: done\n", project->m_inputFileName.sz());
+		}
+	}
+}
+
+bool
+BatchRunner::runProject(
+	BatchProject* project,
+	size_t threadCount
+	)
+{
+	// per-project command line: shared settings (frames, defines) come from the
+	// batch command line; the namespace tree is built in the worker thread itself
+
+	CmdLine cmdLine;
+	cmdLine.m_inputFileName = project->m_inputFileName;
+	cmdLine.m_outputFileName = project->m_outputFileName;
+	cmdLine.m_frameFileName = m_cmdLine->m_frameFileName;
+
+	if (!project->m_configFileName.isEmpty())
+	{
+		cmdLine.m_configFileName = project->m_configFileName;
+		cmdLine.m_configFileNameList.insertTail(project->m_configFileName);
+	}
+	else
+	{
+		cmdLine.m_configFileName = m_cmdLine->m_configFileName;
+
+		sl::ConstBoxIterator<sl::String> it = m_cmdLine->m_configFileNameList.getHead();
+		for (; it; it++)
+			cmdLine.m_configFileNameList.insertTail(*it);
+	}
+
+	sl::ConstBoxIterator<sl::String> it = m_cmdLine->m_frameDirList.getHead();
+	for (; it; it++)
+		cmdLine.m_frameDirList.insertTail(*it);
+
+	sl::ConstIterator<Define> it2 = m_cmdLine->m_defineList.getHead();
+	for (; it2; it2++)
+	{
+		Define* define = AXL_MEM_NEW(Define);
+		define->m_name = it2->m_name;
+		define->m_value = it2->m_value;
+		define->m_hasValue = it2->m_hasValue;
+		cmdLine.m_defineList.insertTail(define);
+	}
+
+	Session session;
+
+	return
+		session.configure(&cmdLine) &&
+		session.loadModel(project->m_inputFileName, threadCount) &&
+		session.render();
+}
+
+//..............................................................................
@@ -0,0 +1,125 @@
+//..............................................................................
+//
+//  This file is part of the Doxyrest toolkit.
+//
+//  Doxyrest is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/doxyrest/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+struct CmdLine;
+
+//..............................................................................
+
+// project list layout (text, one project per line, fields are separated with
+// spaces or tabs; empty lines and lines starting with '#' are ignored):
+//
+//   <input-xml> [<config-file> [<output-file>]]
+//   ...
+//
+// "-" in place of the config file means the config file(s) of the command
+// line; "-" (or nothing) in place of the output file means the OUTPUT_FILE of
+// the config file
+
+struct BatchProject: sl::ListLink
+{
+	sl::String m_inputFileName;
+	sl::String m_configFileName;
+	sl::String m_outputFileName;
+	uint64_t m_cost; // estimated by the size of the input
+	bool m_result;
+	sl::String m_errorString;
+
+	BatchProject()
+	{
+		m_cost = 0;
+		m_result = false;
+	}
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+// runs all the projects of the list on a single pool of worker threads; each
+// project is parsed and rendered by one worker (with its own Session), and the
+// largest projects are started first, so they don't dominate the tail. when
+// there are fewer projects than threads, the spare threads are shared among
+// projects for building the namespace tree (see Session::loadModel)
+
+class BatchRunner
+{
+protected:
+	class WorkerThread: public sys::ThreadImpl<WorkerThread>
+	{
+	public:
+		BatchRunner* m_runner;
+
+	public:
+		void
+		threadFunc()
+		{
+			m_runner->runWorker();
+		}
+	};
+
+protected:
+	const CmdLine* m_cmdLine;
+	sl::List<BatchProject> m_projectList;
+	sl::Array<BatchProject*> m_queue; // sorted by cost, descending
+	size_t m_nextProjectIdx;
+	size_t m_spareThreadCount; // pool threads not running a worker
+	sys::Lock m_lock;
+
+public:
+	BatchRunner()
+	{
+		m_cmdLine = NULL;
+		m_nextProjectIdx = 0;
+		m_spareThreadCount = 0;
+	}
+
+	const sl::List<BatchProject>&
+	getProjectList()
+	{
+		return m_projectList;
+	}
+
+	size_t
+	getFailedProjectCount();
+
+	void
+	addProject(
+		const sl::StringRef& inputFileName,
+		const sl::StringRef& configFileName,
+		const sl::StringRef& outputFileName
+		);
+
+	bool
+	readProjectList(const sl::StringRef& fileName);
+
+	// returns false if any of the projects failed (the first error is set)
+
+	bool
+	run(
+		const CmdLine* cmdLine,
+		size_t threadCount
+		);
+
+protected:
+	BatchProject*
+	getNextProject(size_t* threadCount);
+
+	void
+	runWorker();
+
+	bool
+	runProject(
+		BatchProject* project,
+		size_t threadCount
+		);
+};
+
+//..............................................................................
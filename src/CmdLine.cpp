@@ -14,6 +14,41 @@
 
 //..............................................................................
 
+// 'doxyrest query <input> <pattern>' -- the subcommand comes in place of the
+// input file name
+
+bool
+CmdLineParser::onValue(const sl::StringRef& value)
+{
+	if (m_cmdLine->m_flags & CmdLineFlag_Query)
+	{
+		if (m_cmdLine->m_inputFileName.isEmpty())
+		{
+			m_cmdLine->m_inputFileName = value;
+		}
+		else if (m_cmdLine->m_queryString.isEmpty())
+		{
+			m_cmdLine->m_queryString = value;
+		}
+		else
+		{
+			err::setFormatStringError("unexpected query argument: %s", value.sz());
+			return false;
+		}
+
+		return true;
+	}
+
+	if (value == "query" && m_cmdLine->m_inputFileName.isEmpty())
+	{
+		m_cmdLine->m_flags |= CmdLineFlag_Query;
+		return true;
+	}
+
+	m_cmdLine->m_inputFileName = value;
+	return true;
+}
+
 bool
 CmdLineParser::onSwitch(
 	SwitchKind switchKind,
@@ -30,18 +65,101 @@ CmdLineParser::onSwitch(
 		m_cmdLine->m_flags |= CmdLineFlag_Version;
 		break;
 
+	case CmdLineSwitchKind_Stats:
+		m_cmdLine->m_flags |= CmdLineFlag_Stats;
+		break;
+
 	case CmdLineSwitchKind_ConfigFileName:
-		m_cmdLine->m_configFileName = value;
+		if (m_cmdLine->m_configFileNameList.isEmpty())
+			m_cmdLine->m_configFileName = value;
+
+		m_cmdLine->m_configFileNameList.insertTail(value);
 		break;
 
 	case CmdLineSwitchKind_OutputFileName:
 		m_cmdLine->m_outputFileName = value;
 		break;
 
+	case CmdLineSwitchKind_OutputArchiveFileName:
+		m_cmdLine->m_outputArchiveFileName = value;
+		break;
+
 	case CmdLineSwitchKind_FrameFileName:
 		m_cmdLine->m_frameFileName = value;
 		break;
 
+	case CmdLineSwitchKind_ThreadCount:
+		m_cmdLine->m_threadCount = atoi(value.sz());
+		if (!m_cmdLine->m_threadCount)
+		{
+			err::setFormatStringError("invalid thread count: %s", value.sz());
+			return false;
+		}
+
+		m_cmdLine->m_flags |= CmdLineFlag_Jobs;
+		break;
+
+	case CmdLineSwitchKind_PlanFileName:
+		m_cmdLine->m_planFileName = value;
+		break;
+
+	case CmdLineSwitchKind_Shard:
+		m_cmdLine->m_shardIndex = atoi(value.sz());
+		m_cmdLine->m_shardCount = value.find('/') != -1 ? atoi(value.sz() + value.find('/') + 1) : 0;
+		if (!m_cmdLine->m_shardIndex || m_cmdLine->m_shardIndex > m_cmdLine->m_shardCount)
+		{
+			err::setFormatStringError("invalid shard: %s (expected <k>/<n>, 1 <= k <= n)", value.sz());
+			return false;
+		}
+
+		m_cmdLine->m_shardIndex--; // make it zero-based
+		break;
+
+	case CmdLineSwitchKind_Merge:
+		m_cmdLine->m_flags |= CmdLineFlag_Merge;
+		break;
+
+	case CmdLineSwitchKind_Watch:
+		m_cmdLine->m_flags |= CmdLineFlag_Watch;
+		break;
+
+	case CmdLineSwitchKind_Symbols:
+		m_cmdLine->m_flags |= CmdLineFlag_Symbols;
+		break;
+
+	case CmdLineSwitchKind_QueryMatch:
+		if (value == "exact")
+			m_cmdLine->m_queryMatchKind = SymbolMatchKind_Exact;
+		else if (value == "prefix")
+			m_cmdLine->m_queryMatchKind = SymbolMatchKind_Prefix;
+		else if (value == "fuzzy")
+			m_cmdLine->m_queryMatchKind = SymbolMatchKind_Fuzzy;
+		else
+		{
+			err::setFormatStringError("invalid match mode: %s (expected exact, prefix or fuzzy)", value.sz());
+			return false;
+		}
+
+		break;
+
+	case CmdLineSwitchKind_QueryLimit:
+		m_cmdLine->m_queryLimit = atoi(value.sz());
+		if (!m_cmdLine->m_queryLimit)
+		{
+			err::setFormatStringError("invalid query limit: %s", value.sz());
+			return false;
+		}
+
+		break;
+
+	case CmdLineSwitchKind_SymbolIndexFileName:
+		m_cmdLine->m_symbolIndexFileName = value;
+		break;
+
+	case CmdLineSwitchKind_BatchFileName:
+		m_cmdLine->m_batchFileName = value;
+		break;
+
 	case CmdLineSwitchKind_FrameDir:
 		m_cmdLine->m_frameDirList.insertTail(value);
 		break;
@@ -71,12 +189,58 @@ CmdLineParser::onSwitch(
 bool
 CmdLineParser::finalize()
 {
-	if (m_cmdLine->m_configFileName.isEmpty())
-		if (io::doesFileExist(g_defaultConfigFileName))
-			m_cmdLine->m_configFileName = g_defaultConfigFileName;
+	if ((m_cmdLine->m_shardCount || (m_cmdLine->m_flags & CmdLineFlag_Merge)) &&
+		m_cmdLine->m_planFileName.isEmpty())
+	{
+		err::setError("--shard and --merge require a plan file (--plan)");
+		return false;
+	}
+
+	if (m_cmdLine->m_shardCount && (m_cmdLine->m_flags & CmdLineFlag_Merge))
+	{
+		err::setError("--shard and --merge are mutually exclusive");
+		return false;
+	}
+
+	if ((m_cmdLine->m_flags & CmdLineFlag_Watch) && !m_cmdLine->m_planFileName.isEmpty())
+	{
+		err::setError("--watch can't be combined with --plan");
+		return false;
+	}
+
+	if (!m_cmdLine->m_batchFileName.isEmpty() &&
+		(!m_cmdLine->m_inputFileName.isEmpty() ||
+		!m_cmdLine->m_outputFileName.isEmpty() ||
+		!m_cmdLine->m_outputArchiveFileName.isEmpty() ||
+		!m_cmdLine->m_planFileName.isEmpty() ||
+		(m_cmdLine->m_flags & CmdLineFlag_Watch)))
+	{
+		err::setError("--batch takes inputs and outputs from the project list (and can't be combined with --plan or --watch)");
+		return false;
+	}
+
+	if ((m_cmdLine->m_flags & CmdLineFlag_Query) &&
+		(m_cmdLine->m_inputFileName.isEmpty() || m_cmdLine->m_queryString.isEmpty()))
+	{
+		err::setError("query requires an input XML and a pattern: doxyrest query <doxygen-index.xml> <pattern>");
+		return false;
+	}
+
+	if (m_cmdLine->m_configFileName.isEmpty() && io::doesFileExist(g_defaultConfigFileName))
+	{
+		m_cmdLine->m_configFileName = g_defaultConfigFileName;
+		m_cmdLine->m_configFileNameList.insertTail(g_defaultConfigFileName);
+	}
+
+	if (m_cmdLine->m_configFileNameList.getCount() > 1 && !m_cmdLine->m_planFileName.isEmpty())
+	{
+		err::setError("--plan can't be used with multiple configuration files");
+		return false;
+	}
 
 	if (m_cmdLine->m_inputFileName.isEmpty() &&
 		m_cmdLine->m_configFileName.isEmpty () &&
+		m_cmdLine->m_batchFileName.isEmpty() &&
 		!m_cmdLine->m_flags)
 		m_cmdLine->m_flags = CmdLineFlag_Help;
 
@@ -12,6 +12,7 @@
 #pragma once
 
 #include "DoxyXmlEnum.h"
+#include "SymbolIndex.h"
 
 //..............................................................................
 
@@ -19,6 +20,12 @@ enum CmdLineFlag
 {
 	CmdLineFlag_Help    = 0x0001,
 	CmdLineFlag_Version = 0x0002,
+	CmdLineFlag_Stats   = 0x0004,
+	CmdLineFlag_Merge   = 0x0008,
+	CmdLineFlag_Watch   = 0x0010,
+	CmdLineFlag_Symbols = 0x0020,
+	CmdLineFlag_Query   = 0x0040,
+	CmdLineFlag_Jobs    = 0x0080, // -j was specified explicitly
 };
 
 // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
@@ -40,16 +47,32 @@ struct Define: sl::ListLink
 struct CmdLine
 {
 	uint_t m_flags;
-	sl::String m_configFileName;
+	sl::String m_configFileName; // the first one
+	sl::BoxList<sl::String> m_configFileNameList;
 	sl::String m_inputFileName;
 	sl::String m_outputFileName;
+	sl::String m_outputArchiveFileName;
 	sl::String m_frameFileName;
 	sl::BoxList<sl::String> m_frameDirList;
 	sl::List<Define> m_defineList;
+	size_t m_threadCount;
+	sl::String m_planFileName;
+	size_t m_shardIndex; // zero-based
+	size_t m_shardCount; // 0 means "not a shard run"
+	sl::String m_batchFileName;
+	sl::String m_queryString;
+	SymbolMatchKind m_queryMatchKind;
+	size_t m_queryLimit;
+	sl::String m_symbolIndexFileName;
 
 	CmdLine()
 	{
 		m_flags = 0;
+		m_threadCount = 1;
+		m_shardIndex = 0;
+		m_shardCount = 0;
+		m_queryMatchKind = SymbolMatchKind_Prefix;
+		m_queryLimit = 20;
 	}
 };
 
@@ -68,9 +91,21 @@ enum CmdLineSwitchKind
 	CmdLineSwitchKind_Version,
 	CmdLineSwitchKind_ConfigFileName,
 	CmdLineSwitchKind_OutputFileName,
+	CmdLineSwitchKind_OutputArchiveFileName,
 	CmdLineSwitchKind_FrameFileName,
 	CmdLineSwitchKind_FrameDir,
 	CmdLineSwitchKind_Define,
+	CmdLineSwitchKind_Stats,
+	CmdLineSwitchKind_ThreadCount,
+	CmdLineSwitchKind_PlanFileName,
+	CmdLineSwitchKind_Shard,
+	CmdLineSwitchKind_Merge,
+	CmdLineSwitchKind_Watch,
+	CmdLineSwitchKind_BatchFileName,
+	CmdLineSwitchKind_Symbols,
+	CmdLineSwitchKind_QueryMatch,
+	CmdLineSwitchKind_QueryLimit,
+	CmdLineSwitchKind_SymbolIndexFileName,
 };
 
 // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
@@ -91,7 +126,7 @@ AXL_SL_BEGIN_CMD_LINE_SWITCH_TABLE(CmdLineSwitchTable, CmdLineSwitchKind)
 	AXL_SL_CMD_LINE_SWITCH_2(
 		CmdLineSwitchKind_ConfigFileName,
 		"c", "config", "<file>",
-		"Specify configuration file (default: doxyrest-config.lua)"
+		"Specify configuration file (multiple allowed; default: doxyrest-config.lua)"
 		)
 
 	AXL_SL_CMD_LINE_SWITCH_2(
@@ -100,6 +135,12 @@ AXL_SL_BEGIN_CMD_LINE_SWITCH_TABLE(CmdLineSwitchTable, CmdLineSwitchKind)
 		"Specify master (index) output file"
 		)
 
+	AXL_SL_CMD_LINE_SWITCH_2(
+		CmdLineSwitchKind_OutputArchiveFileName,
+		"a", "output-archive", "<file>",
+		"Pack all output files into a single uncompressed tar archive"
+		)
+
 	AXL_SL_CMD_LINE_SWITCH_2(
 		CmdLineSwitchKind_FrameFileName,
 		"f", "frame", "<file>",
@@ -117,6 +158,72 @@ AXL_SL_BEGIN_CMD_LINE_SWITCH_TABLE(CmdLineSwitchTable, CmdLineSwitchKind)
 		"D", "define", "<name>[=<value>]",
 		"Define a Lua variable"
 		)
+
+	AXL_SL_CMD_LINE_SWITCH_2(
+		CmdLineSwitchKind_Stats,
+		"s", "stats", NULL,
+		"Print memory statistics"
+		)
+
+	AXL_SL_CMD_LINE_SWITCH_2(
+		CmdLineSwitchKind_ThreadCount,
+		"j", "jobs", "<n>",
+		"Use <n> threads for building the namespace tree (default: 1) or for --batch (default: CPU cores)"
+		)
+
+	AXL_SL_CMD_LINE_SWITCH_2(
+		CmdLineSwitchKind_PlanFileName,
+		"p", "plan", "<file>",
+		"Write generation plan (or read it with --shard/--merge)"
+		)
+
+	AXL_SL_CMD_LINE_SWITCH_2(
+		CmdLineSwitchKind_Shard,
+		"S", "shard", "<k>/<n>",
+		"Render only the k-th of n shares of the planned files"
+		)
+
+	AXL_SL_CMD_LINE_SWITCH_2(
+		CmdLineSwitchKind_Merge,
+		"m", "merge", NULL,
+		"Render only the files not covered by the plan (master, crefdb)"
+		)
+
+	AXL_SL_CMD_LINE_SWITCH_2(
+		CmdLineSwitchKind_Watch,
+		"w", "watch", NULL,
+		"Stay resident and regenerate on changes of XML, frames or config"
+		)
+
+	AXL_SL_CMD_LINE_SWITCH_2(
+		CmdLineSwitchKind_BatchFileName,
+		"B", "batch", "<file>",
+		"Process all projects of a list on a shared thread pool"
+		)
+
+	AXL_SL_CMD_LINE_SWITCH_2(
+		CmdLineSwitchKind_Symbols,
+		"l", "list-symbols", NULL,
+		"Print the symbol table from index.xml (without parsing compounds)"
+		)
+
+	AXL_SL_CMD_LINE_SWITCH_2(
+		CmdLineSwitchKind_QueryMatch,
+		"M", "match", "<exact|prefix|fuzzy>",
+		"Specify query match mode (default: prefix)"
+		)
+
+	AXL_SL_CMD_LINE_SWITCH_2(
+		CmdLineSwitchKind_QueryLimit,
+		"n", "limit", "<n>",
+		"Return at most <n> query results (default: 20)"
+		)
+
+	AXL_SL_CMD_LINE_SWITCH_2(
+		CmdLineSwitchKind_SymbolIndexFileName,
+		"C", "symbol-cache", "<file>",
+		"Specify query symbol index file (default: <input>.symbols)"
+		)
 AXL_SL_END_CMD_LINE_SWITCH_TABLE()
 
 // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
@@ -136,11 +243,7 @@ public:
 
 protected:
 	bool
-	onValue(const sl::StringRef& value)
-	{
-		m_cmdLine->m_inputFileName = value;
-		return true;
-	}
+	onValue(const sl::StringRef& value);
 
 	bool
 	onSwitch(
@@ -0,0 +1,98 @@
+//..............................................................................
+//
+//  This file is part of the Doxyrest toolkit.
+//
+//  Doxyrest is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/doxyrest/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "CrefDb.h"
+#include "OutputSink.h"
+
+//..............................................................................
+
+struct CrefDbSortEntry
+{
+	const sl::String* m_name;
+	const sl::String* m_target;
+};
+
+// byte-wise comparison -- must match bisection over python bytes objects
+
+inline
+bool
+isCrefDbNameLess(
+	const CrefDbSortEntry& entry1,
+	const CrefDbSortEntry& entry2
+	)
+{
+	size_t length1 = entry1.m_name->getLength();
+	size_t length2 = entry2.m_name->getLength();
+	int cmp = memcmp(entry1.m_name->cp(), entry2.m_name->cp(), AXL_MIN(length1, length2));
+	return cmp ? cmp < 0 : length1 < length2;
+}
+
+bool
+CrefDb::write(
+	OutputSink* sink,
+	const sl::StringRef& filePath
+	)
+{
+	size_t count = m_map.getCount();
+
+	sl::Array<CrefDbSortEntry> sortArray;
+	sortArray.setCount(count);
+
+	sl::StringHashTableIterator<sl::String> it = m_map.getHead();
+	for (size_t i = 0; it; it++, i++)
+	{
+		sortArray[i].m_name = &it->getKey();
+		sortArray[i].m_target = &it->m_value;
+	}
+
+	std::sort(sortArray.p(), sortArray.p() + count, isCrefDbNameLess);
+
+	size_t poolOffset = sizeof(CrefDbHdr) + count * sizeof(CrefDbEntry);
+
+	sl::Array<char> buffer;
+	buffer.setCount(poolOffset);
+
+	CrefDbHdr* hdr = (CrefDbHdr*)buffer.p();
+	memcpy(hdr->m_signature, DOXYREST_CREFDB_SIGNATURE, sizeof(hdr->m_signature));
+	hdr->m_version = CrefDbVersion_Current;
+	hdr->m_entryCount = (uint32_t)count;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		const sl::String* name = sortArray[i].m_name;
+		const sl::String* target = sortArray[i].m_target;
+
+		CrefDbEntry entry;
+		entry.m_nameOffset = (uint32_t)buffer.getCount();
+		entry.m_nameLength = (uint32_t)name->getLength();
+		buffer.append(name->cp(), name->getLength());
+
+		entry.m_targetOffset = (uint32_t)buffer.getCount();
+		entry.m_targetLength = (uint32_t)target->getLength();
+		buffer.append(target->cp(), target->getLength());
+
+		// buffer may have been reallocated by now, so re-fetch the entry table
+
+		CrefDbEntry* entryTable = (CrefDbEntry*)(buffer.p() + sizeof(CrefDbHdr));
+		entryTable[i] = entry;
+	}
+
+	if (buffer.getCount() > UINT32_MAX)
+	{
+		err::setFormatStringError("cref database '%s' is too big", filePath.sz());
+		return false;
+	}
+
+	return sink->writeFile(filePath, buffer.cp(), buffer.getCount());
+}
+
+//..............................................................................
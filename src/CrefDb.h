@@ -0,0 +1,90 @@
+//..............................................................................
+//
+//  This file is part of the Doxyrest toolkit.
+//
+//  Doxyrest is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/doxyrest/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+class OutputSink;
+
+//..............................................................................
+
+// crefdb.bin layout (all integers are little-endian uint32):
+//
+//   CrefDbHdr
+//   CrefDbEntry[m_entryCount]  -- sorted by name (byte-wise)
+//   string pool                -- names and targets, not null-terminated
+//
+// sphinx/doxyrest.py maps this file and bisects the entry table on lookup
+
+#define DOXYREST_CREFDB_SIGNATURE "DXRCRFDB"
+
+enum
+{
+	CrefDbVersion_Current = 1,
+};
+
+struct CrefDbHdr
+{
+	char m_signature[8];
+	uint32_t m_version;
+	uint32_t m_entryCount;
+};
+
+struct CrefDbEntry
+{
+	uint32_t m_nameOffset;
+	uint32_t m_nameLength;
+	uint32_t m_targetOffset;
+	uint32_t m_targetLength;
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+class CrefDb
+{
+protected:
+	sl::StringHashTable<sl::String> m_map;
+
+public:
+	bool
+	isEmpty()
+	{
+		return m_map.isEmpty();
+	}
+
+	size_t
+	getCount()
+	{
+		return m_map.getCount();
+	}
+
+	void
+	clear()
+	{
+		m_map.clear();
+	}
+
+	void
+	add(
+		const sl::StringRef& name,
+		const sl::StringRef& target
+		)
+	{
+		m_map.visit(name)->m_value = target; // later entries win (as with the old python dict)
+	}
+
+	bool
+	write(
+		OutputSink* sink,
+		const sl::StringRef& filePath
+		);
+};
+
+//..............................................................................
@@ -0,0 +1,741 @@
+//..............................................................................
+//
+//  This file is part of the Doxyrest toolkit.
+//
+//  Doxyrest is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/doxyrest/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "DoxyXmlArchive.h"
+
+#if (_AXL_OS_WIN)
+#	include <io.h>
+#	include <fcntl.h>
+#elif (_AXL_OS_POSIX)
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <sys/wait.h>
+#	include <spawn.h>
+extern char** environ;
+#endif
+
+//..............................................................................
+
+DoxyXmlArchiveKind
+getDoxyXmlArchiveKind(const sl::StringRef& fileName)
+{
+	static const struct
+	{
+		const char* m_suffix;
+		DoxyXmlArchiveKind m_kind;
+	} suffixTable[] =
+	{
+		{ ".tar",     DoxyXmlArchiveKind_Tar },
+		{ ".tar.xz",  DoxyXmlArchiveKind_TarXz },
+		{ ".txz",     DoxyXmlArchiveKind_TarXz },
+		{ ".tar.zst", DoxyXmlArchiveKind_TarZst },
+		{ ".tzst",    DoxyXmlArchiveKind_TarZst },
+		{ ".zip",     DoxyXmlArchiveKind_Zip },
+	};
+
+	for (size_t i = 0; i < countof(suffixTable); i++)
+		if (fileName.isSuffix(suffixTable[i].m_suffix))
+			return suffixTable[i].m_kind;
+
+	return DoxyXmlArchiveKind_Undefined;
+}
+
+//..............................................................................
+
+static
+uint64_t
+parseTarNumber(
+	const char* p,
+	size_t length
+	)
+{
+	uint64_t value = 0;
+
+	if (*p & 0x80) // GNU base-256 extension for huge files
+	{
+		value = *p & 0x7f;
+		for (size_t i = 1; i < length; i++)
+			value = (value << 8) | (uchar_t)p[i];
+
+		return value;
+	}
+
+	const char* end = p + length;
+	while (p < end && *p == ' ')
+		p++;
+
+	for (; p < end && *p >= '0' && *p <= '7'; p++)
+		value = (value << 3) | (*p - '0');
+
+	return value;
+}
+
+static
+bool
+isTarChecksumValid(const char* hdr)
+{
+	uint64_t expected = parseTarNumber(hdr + TarDef_ChecksumOffset, TarDef_ChecksumLength);
+	uint64_t sum = 0;
+
+	for (size_t i = 0; i < TarDef_BlockSize; i++)
+		sum += i >= TarDef_ChecksumOffset && i < TarDef_ChecksumOffset + TarDef_ChecksumLength ?
+			' ' :
+			(uchar_t)hdr[i];
+
+	return sum == expected;
+}
+
+static
+sl::String
+getTarString(
+	const char* p,
+	size_t maxLength
+	)
+{
+	const char* end = (const char*)memchr(p, 0, maxLength);
+	return sl::String(p, end ? end - p : maxLength);
+}
+
+static
+sl::String
+getPaxPath(
+	const char* p,
+	size_t size
+	)
+{
+	// records are formatted as "<length> <key>=<value>\n"
+
+	const char* end = p + size;
+	while (p < end)
+	{
+		size_t length = strtoul(p, NULL, 10);
+		if (!length || length > (size_t)(end - p))
+			break;
+
+		const char* record = (const char*)memchr(p, ' ', length);
+		if (record && (size_t)(p + length - record) > 6 && !memcmp(record + 1, "path=", 5))
+			return sl::String(record + 6, p + length - record - 7); // drop trailing '\n'
+
+		p += length;
+	}
+
+	return sl::String();
+}
+
+static
+sl::String
+normalizeArchivePath(const sl::StringRef& path)
+{
+	const char* p = path.cp();
+	const char* end = p + path.getLength();
+
+	while (end - p >= 2 && p[0] == '.' && p[1] == '/')
+		p += 2;
+
+	while (p < end && *p == '/')
+		p++;
+
+	return sl::String(p, end - p);
+}
+
+#if (_AXL_OS_WIN)
+
+// CreateProcess takes a single command line which the child splits back into
+// arguments (CommandLineToArgvW rules: backslashes are only special in front
+// of a double quote)
+
+static
+void
+appendWinCmdLineArg(
+	sl::String_w* cmdLine,
+	const sl::StringRef& arg
+	)
+{
+	if (!cmdLine->isEmpty())
+		*cmdLine += L' ';
+
+	if (!arg.isEmpty() && arg.findOneOf(" \t\"") == -1)
+	{
+		*cmdLine += sl::String_w(arg);
+		return;
+	}
+
+	sl::String_w argW = arg;
+	const wchar_t* p = argW.cp();
+	const wchar_t* end = p + argW.getLength();
+
+	*cmdLine += L'"';
+
+	for (;;)
+	{
+		size_t backslashCount = 0;
+		while (p < end && *p == L'\\')
+		{
+			p++;
+			backslashCount++;
+		}
+
+		if (p >= end)
+		{
+			cmdLine->append(L'\\', backslashCount * 2);
+			break;
+		}
+
+		if (*p == L'"')
+			cmdLine->append(L'\\', backslashCount * 2 + 1);
+		else
+			cmdLine->append(L'\\', backslashCount);
+
+		cmdLine->append(p, 1);
+		p++;
+	}
+
+	*cmdLine += L'"';
+}
+
+#endif
+
+//..............................................................................
+
+bool
+DoxyXmlArchive::open(const sl::StringRef& fileName)
+{
+	close();
+
+	m_kind = getDoxyXmlArchiveKind(fileName);
+	m_fileName = fileName;
+
+	bool result;
+
+	switch (m_kind)
+	{
+	case DoxyXmlArchiveKind_Tar:
+		result = readTarFile(fileName);
+		break;
+
+	case DoxyXmlArchiveKind_TarXz:
+		result = readTarPipe("xz");
+		break;
+
+	case DoxyXmlArchiveKind_TarZst:
+		result = readTarPipe("zstd");
+		break;
+
+	case DoxyXmlArchiveKind_Zip:
+		result = m_zipReader.openFile(fileName) && buildZipToc();
+		break;
+
+	default:
+		err::setFormatStringError("'%s' is not a supported archive", fileName.sz());
+		return false;
+	}
+
+	if (!result)
+	{
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+void
+DoxyXmlArchive::close()
+{
+	m_kind = DoxyXmlArchiveKind_Undefined;
+	m_fileName.clear();
+	unmapTarFile();
+	m_zipReader.close();
+	m_toc.clear();
+}
+
+sl::String
+DoxyXmlArchive::findIndexFile()
+{
+	// prefer the outermost index.xml (e.g. 'xml/index.xml' over 'xml/foo/index.xml')
+
+	sl::String indexPath;
+	size_t indexPathLength = -1;
+
+	sl::StringHashTableIterator<DoxyXmlArchiveEntry> it = m_toc.getHead();
+	for (; it; it++)
+	{
+		const sl::String& path = it->getKey();
+		size_t length = path.getLength();
+
+		if (length < indexPathLength &&
+			(path == "index.xml" || path.isSuffix("/index.xml")))
+		{
+			indexPath = path;
+			indexPathLength = length;
+		}
+	}
+
+	return indexPath;
+}
+
+bool
+DoxyXmlArchive::openFile(
+	const sl::StringRef& path,
+	DoxyXmlArchiveFile* file
+	)
+{
+	sl::StringHashTableIterator<DoxyXmlArchiveEntry> it = m_toc.find(path);
+	if (!it)
+	{
+		err::setFormatStringError("'%s' not found in '%s'", path.sz(), m_fileName.sz());
+		return false;
+	}
+
+	const DoxyXmlArchiveEntry& entry = it->m_value;
+
+	if (m_kind != DoxyXmlArchiveKind_Zip)
+	{
+		file->m_p = m_tarData + entry.m_offset;
+		file->m_size = entry.m_size;
+		return true;
+	}
+
+	bool result = m_zipReader.extractFileToMem(entry.m_offset, &file->m_buffer);
+	if (!result)
+		return false;
+
+	file->m_p = file->m_buffer.cp();
+	file->m_size = file->m_buffer.getCount();
+	return true;
+}
+
+bool
+DoxyXmlArchive::readTarFile(const sl::StringRef& fileName)
+{
+	FILE* stream = fopen(fileName.sz(), "rb");
+	if (!stream)
+	{
+		err::setFormatStringError("can't open '%s': %s", fileName.sz(), strerror(errno));
+		return false;
+	}
+
+#if (_AXL_OS_POSIX)
+	bool result = mapTarFile(stream) && buildTarToc();
+#else
+	bool result = readTarStream(stream);
+#endif
+
+	fclose(stream);
+	return result;
+}
+
+bool
+DoxyXmlArchive::readTarPipe(const char* toolName)
+{
+	// decompression is delegated to the standard tools (which are present
+	// wherever these archives are produced) -- we consume the tar as a stream.
+	// the tool is started directly (no shell), so the file name is passed as is
+
+	const char* argv[] =
+	{
+		toolName,
+		"-dc",
+		"--",
+		m_fileName.sz(),
+		NULL
+	};
+
+#if (_AXL_OS_WIN)
+	sl::String_w cmdLine;
+	for (size_t i = 0; argv[i]; i++)
+		appendWinCmdLineArg(&cmdLine, argv[i]);
+
+	SECURITY_ATTRIBUTES secAttr = { 0 };
+	secAttr.nLength = sizeof(secAttr);
+	secAttr.bInheritHandle = TRUE;
+
+	HANDLE readPipe;
+	HANDLE writePipe;
+	bool_t result = ::CreatePipe(&readPipe, &writePipe, &secAttr, 0);
+	if (!result)
+	{
+		err::setLastSystemError();
+		return false;
+	}
+
+	::SetHandleInformation(readPipe, HANDLE_FLAG_INHERIT, 0); // only the write end goes to the child
+
+	STARTUPINFOW startupInfo = { 0 };
+	startupInfo.cb = sizeof(startupInfo);
+	startupInfo.dwFlags = STARTF_USESTDHANDLES;
+	startupInfo.hStdInput = ::GetStdHandle(STD_INPUT_HANDLE);
+	startupInfo.hStdOutput = writePipe;
+	startupInfo.hStdError = ::GetStdHandle(STD_ERROR_HANDLE);
+
+	PROCESS_INFORMATION processInfo;
+	result = ::CreateProcessW(
+		NULL,
+		cmdLine.p(),
+		NULL,
+		NULL,
+		TRUE,
+		0,
+		NULL,
+		NULL,
+		&startupInfo,
+		&processInfo
+		);
+
+	if (!result)
+	{
+		err::setLastSystemError();
+		err::setFormatStringError("can't run '%s': %s", toolName, err::getLastErrorDescription().sz());
+		::CloseHandle(readPipe);
+		::CloseHandle(writePipe);
+		return false;
+	}
+
+	::CloseHandle(writePipe);
+
+	::CloseHandle(processInfo.hThread);
+
+	int fd = _open_osfhandle((intptr_t)readPipe, _O_RDONLY | _O_BINARY);
+	FILE* stream = fd != -1 ? _fdopen(fd, "rb") : NULL;
+	if (!stream)
+	{
+		if (fd != -1)
+			_close(fd);
+		else
+			::CloseHandle(readPipe);
+
+		::TerminateProcess(processInfo.hProcess, 1);
+		::CloseHandle(processInfo.hProcess);
+		err::setFormatStringError("can't read the output of '%s'", toolName);
+		return false;
+	}
+
+	bool isRead = readTarStream(stream);
+	fclose(stream); // a tool still writing gets a broken pipe and exits
+
+	dword_t exitCode = -1;
+	::WaitForSingleObject(processInfo.hProcess, INFINITE);
+	::GetExitCodeProcess(processInfo.hProcess, &exitCode);
+	::CloseHandle(processInfo.hProcess);
+
+	if (!isRead)
+		return false;
+
+	if (exitCode != 0)
+	{
+		err::setFormatStringError("'%s' failed on '%s' (exit code %d)", toolName, m_fileName.sz(), (int)exitCode);
+		return false;
+	}
+#else
+	int fd[2];
+	int error = pipe(fd);
+	if (error)
+	{
+		err::setFormatStringError("can't create a pipe: %s", strerror(errno));
+		return false;
+	}
+
+	posix_spawn_file_actions_t fileActions;
+	posix_spawn_file_actions_init(&fileActions);
+	posix_spawn_file_actions_adddup2(&fileActions, fd[1], STDOUT_FILENO);
+	posix_spawn_file_actions_addclose(&fileActions, fd[0]);
+	posix_spawn_file_actions_addclose(&fileActions, fd[1]);
+
+	pid_t pid;
+	error = posix_spawnp(&pid, toolName, &fileActions, NULL, (char* const*)argv, environ);
+	posix_spawn_file_actions_destroy(&fileActions);
+	close(fd[1]);
+
+	if (error)
+	{
+		close(fd[0]);
+		err::setFormatStringError("can't run '%s': %s", toolName, strerror(error));
+		return false;
+	}
+
+	FILE* stream = fdopen(fd[0], "r");
+	if (!stream)
+	{
+		err::setFormatStringError("can't read the output of '%s': %s", toolName, strerror(errno));
+		close(fd[0]);
+	}
+
+	bool isRead = stream && readTarStream(stream);
+	if (stream)
+		fclose(stream); // a tool still writing gets SIGPIPE and exits
+
+	int status;
+	pid_t waitResult;
+
+	do
+	{
+		waitResult = waitpid(pid, &status, 0);
+	} while (waitResult == -1 && errno == EINTR);
+
+	if (!isRead)
+		return false;
+
+	if (waitResult == -1)
+	{
+		err::setFormatStringError("can't wait for '%s': %s", toolName, strerror(errno));
+		return false;
+	}
+
+	if (WIFSIGNALED(status))
+	{
+		err::setFormatStringError("'%s' failed on '%s' (signal %d)", toolName, m_fileName.sz(), WTERMSIG(status));
+		return false;
+	}
+
+	// posix_spawnp may report a missing tool via exit code 127 rather than an error
+
+	if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+	{
+		err::setFormatStringError("'%s' failed on '%s' (exit code %d)", toolName, m_fileName.sz(), WEXITSTATUS(status));
+		return false;
+	}
+#endif
+
+	return true;
+}
+
+bool
+DoxyXmlArchive::readTarStream(FILE* stream)
+{
+	enum
+	{
+		ReadBlockSize = 1 * 1024 * 1024, // 1M
+	};
+
+#if (_AXL_OS_POSIX)
+	// spill the decompressed stream into an unlinked temporary file and map
+	// it; pages of already parsed compounds can then be dropped by the kernel
+	// instead of pinning the whole uncompressed tar on the heap
+
+	FILE* tmpStream = tmpfile();
+	if (!tmpStream)
+	{
+		err::setFormatStringError("can't create a temporary file: %s", strerror(errno));
+		return false;
+	}
+
+	char* buffer = (char*)malloc(ReadBlockSize);
+	bool result = true;
+
+	for (;;)
+	{
+		size_t size = fread(buffer, 1, ReadBlockSize, stream);
+		if (size && fwrite(buffer, 1, size, tmpStream) != size)
+		{
+			err::setFormatStringError("error writing a temporary file: %s", strerror(errno));
+			result = false;
+			break;
+		}
+
+		if (size < ReadBlockSize)
+			break;
+	}
+
+	free(buffer);
+
+	if (result && ferror(stream))
+	{
+		err::setFormatStringError("error reading '%s'", m_fileName.sz());
+		result = false;
+	}
+
+	if (result && fflush(tmpStream) != 0)
+	{
+		err::setFormatStringError("error writing a temporary file: %s", strerror(errno));
+		result = false;
+	}
+
+	result = result && mapTarFile(tmpStream);
+	fclose(tmpStream); // the mapping keeps the (already unlinked) file alive
+	return result && buildTarToc();
+#else
+	for (;;)
+	{
+		size_t offset = m_tarBuffer.getCount();
+		m_tarBuffer.setCount(offset + ReadBlockSize);
+
+		size_t size = fread(m_tarBuffer.p() + offset, 1, ReadBlockSize, stream);
+		m_tarBuffer.setCount(offset + size);
+
+		if (size < ReadBlockSize)
+			break;
+	}
+
+	if (ferror(stream))
+	{
+		err::setFormatStringError("error reading '%s'", m_fileName.sz());
+		return false;
+	}
+
+	m_tarData = m_tarBuffer.cp();
+	m_tarSize = m_tarBuffer.getCount();
+	return buildTarToc();
+#endif
+}
+
+#if (_AXL_OS_POSIX)
+
+bool
+DoxyXmlArchive::mapTarFile(FILE* stream)
+{
+	int fd = fileno(stream);
+
+	struct stat st;
+	int result = ::fstat(fd, &st);
+	if (result == -1)
+	{
+		err::setLastSystemError();
+		return false;
+	}
+
+	m_tarSize = st.st_size;
+	if (!m_tarSize) // can't map an empty file; an empty archive has no entries anyway
+		return true;
+
+	void* view = ::mmap(NULL, m_tarSize, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (view == MAP_FAILED)
+	{
+		err::setLastSystemError();
+		m_tarSize = 0;
+		return false;
+	}
+
+	m_tarData = (const char*)view;
+	return true;
+}
+
+void
+DoxyXmlArchive::unmapTarFile()
+{
+	if (m_tarData)
+		::munmap((void*)m_tarData, m_tarSize);
+
+	m_tarData = NULL;
+	m_tarSize = 0;
+}
+
+#else
+
+void
+DoxyXmlArchive::unmapTarFile()
+{
+	m_tarBuffer.clear();
+	m_tarData = NULL;
+	m_tarSize = 0;
+}
+
+#endif
+
+bool
+DoxyXmlArchive::buildTarToc()
+{
+	const char* p = m_tarData;
+	size_t totalSize = m_tarSize;
+	size_t offset = 0;
+	sl::String longName;
+
+	while (offset + TarDef_BlockSize <= totalSize)
+	{
+		const char* hdr = p + offset;
+		if (!hdr[0]) // end-of-archive marker
+			break;
+
+		if (!isTarChecksumValid(hdr))
+		{
+			err::setFormatStringError("'%s': invalid tar header at offset %d", m_fileName.sz(), (int)offset);
+			return false;
+		}
+
+		uint64_t size = parseTarNumber(hdr + TarDef_SizeOffset, TarDef_SizeLength);
+		size_t dataOffset = offset + TarDef_BlockSize;
+		uint64_t nextOffset = dataOffset + ((size + TarDef_BlockSize - 1) & ~(uint64_t)(TarDef_BlockSize - 1));
+		if (nextOffset > totalSize)
+		{
+			err::setFormatStringError("'%s': unexpected end of archive", m_fileName.sz());
+			return false;
+		}
+
+		const char* data = p + dataOffset;
+		char type = hdr[TarDef_TypeOffset];
+		sl::String path;
+		DoxyXmlArchiveEntry entry;
+
+		switch (type)
+		{
+		case 'L': // GNU long name for the next entry
+			longName = getTarString(data, (size_t)size);
+			break;
+
+		case 'x': // pax extended header for the next entry
+			longName = getPaxPath(data, (size_t)size);
+			break;
+
+		case '0':
+		case '7':
+		case 0:
+			if (!longName.isEmpty())
+			{
+				path = longName;
+			}
+			else
+			{
+				path = getTarString(hdr + TarDef_NameOffset, TarDef_NameLength);
+
+				if (!memcmp(hdr + TarDef_MagicOffset, "ustar", 5) && hdr[TarDef_PrefixOffset])
+					path = getTarString(hdr + TarDef_PrefixOffset, TarDef_PrefixLength) + "/" + path;
+			}
+
+			entry.m_offset = dataOffset;
+			entry.m_size = (size_t)size;
+			m_toc.visit(normalizeArchivePath(path))->m_value = entry;
+
+			// fall through
+
+		default: // directories, links, global pax headers, etc
+			longName.clear();
+		}
+
+		offset = (size_t)nextOffset;
+	}
+
+	return true;
+}
+
+bool
+DoxyXmlArchive::buildZipToc()
+{
+	size_t count = m_zipReader.getFileCount();
+	for (size_t i = 0; i < count; i++)
+	{
+		if (m_zipReader.isDirectoryFile(i))
+			continue;
+
+		zip::ZipFileInfo fileInfo;
+		bool result = m_zipReader.getFileInfo(i, &fileInfo);
+		if (!result)
+			return false;
+
+		DoxyXmlArchiveEntry entry;
+		entry.m_offset = i;
+		entry.m_size = (size_t)fileInfo.m_uncompressedSize;
+		m_toc.visit(normalizeArchivePath(m_zipReader.getFileName(i)))->m_value = entry;
+	}
+
+	return true;
+}
+
+//..............................................................................
@@ -0,0 +1,158 @@
+//..............................................................................
+//
+//  This file is part of the Doxyrest toolkit.
+//
+//  Doxyrest is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/doxyrest/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+//..............................................................................
+
+enum DoxyXmlArchiveKind
+{
+	DoxyXmlArchiveKind_Undefined,
+	DoxyXmlArchiveKind_Tar,
+	DoxyXmlArchiveKind_TarXz,
+	DoxyXmlArchiveKind_TarZst,
+	DoxyXmlArchiveKind_Zip,
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+DoxyXmlArchiveKind
+getDoxyXmlArchiveKind(const sl::StringRef& fileName);
+
+//..............................................................................
+
+// ustar header layout (shared with the tar output sink)
+
+enum TarDef
+{
+	TarDef_BlockSize      = 512,
+	TarDef_NameOffset     = 0,
+	TarDef_NameLength     = 100,
+	TarDef_ModeOffset     = 100,
+	TarDef_ModeLength     = 8,
+	TarDef_SizeOffset     = 124,
+	TarDef_SizeLength     = 12,
+	TarDef_MtimeOffset    = 136,
+	TarDef_MtimeLength    = 12,
+	TarDef_ChecksumOffset = 148,
+	TarDef_ChecksumLength = 8,
+	TarDef_TypeOffset     = 156,
+	TarDef_MagicOffset    = 257,
+	TarDef_PrefixOffset   = 345,
+	TarDef_PrefixLength   = 155,
+};
+
+//..............................................................................
+
+struct DoxyXmlArchiveEntry
+{
+	size_t m_offset; // tar: offset in the decompressed stream; zip: file index
+	size_t m_size;
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+struct DoxyXmlArchiveFile
+{
+	const char* m_p;
+	size_t m_size;
+	sl::Array<char> m_buffer; // only used for members extracted from zip
+};
+
+//..............................................................................
+
+// Doxygen XML output packed into a single archive; plain tarballs are mapped
+// as is, compressed ones are decompressed in one sequential pass into an
+// unlinked temporary file which is then mapped -- so the decompressed data
+// lives in the (reclaimable) page cache rather than on the heap; zip members
+// are inflated on demand
+
+class DoxyXmlArchive
+{
+protected:
+	DoxyXmlArchiveKind m_kind;
+	sl::String m_fileName;
+	const char* m_tarData;
+	size_t m_tarSize;
+	sl::Array<char> m_tarBuffer; // only used where mapping is not available
+	zip::ZipReader m_zipReader;
+	sl::StringHashTable<DoxyXmlArchiveEntry> m_toc;
+
+public:
+	DoxyXmlArchive()
+	{
+		m_kind = DoxyXmlArchiveKind_Undefined;
+		m_tarData = NULL;
+		m_tarSize = 0;
+	}
+
+	~DoxyXmlArchive()
+	{
+		close();
+	}
+
+	DoxyXmlArchiveKind
+	getKind()
+	{
+		return m_kind;
+	}
+
+	const sl::String&
+	getFileName()
+	{
+		return m_fileName;
+	}
+
+	size_t
+	getFileCount()
+	{
+		return m_toc.getCount();
+	}
+
+	bool
+	open(const sl::StringRef& fileName);
+
+	void
+	close();
+
+	sl::String
+	findIndexFile();
+
+	bool
+	openFile(
+		const sl::StringRef& path,
+		DoxyXmlArchiveFile* file
+		);
+
+protected:
+	bool
+	readTarFile(const sl::StringRef& fileName);
+
+	bool
+	readTarPipe(const char* toolName); // runs '<toolName> -dc -- <m_fileName>'
+
+	bool
+	readTarStream(FILE* stream);
+
+	bool
+	mapTarFile(FILE* stream);
+
+	void
+	unmapTarFile();
+
+	bool
+	buildTarToc();
+
+	bool
+	buildZipToc();
+};
+
+//..............................................................................
@@ -13,12 +13,133 @@
 #include "DoxyXmlParser.h"
 #include "DoxyXmlType.h"
 
+#if (_AXL_OS_POSIX)
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <fcntl.h>
+#	include <unistd.h>
+#endif
+
+//..............................................................................
+
+// compound-level elements doxyrest has no use for; these are often huge
+// (e.g. programlisting of a whole source file)
+
+static const char* g_skipElementNameTable[] =
+{
+	"listofallmembers",
+	"programlisting",
+	"incdepgraph",
+	"invincdepgraph",
+	"collaborationgraph",
+	"inheritancegraph",
+};
+
+inline
+bool
+isTagNameEnd(char c)
+{
+	return c == '>' || c == '/' || isspace((uchar_t)c);
+}
+
+static
+const char*
+findSkipCandidate(
+	const char* p,
+	const char* limit, // candidates must start before limit
+	const char* end,
+	const char** name,
+	size_t* nameLength
+	)
+{
+	for (;;)
+	{
+		p = (const char*)memchr(p, '<', limit - p);
+		if (!p)
+			return NULL;
+
+		p++;
+
+		for (size_t i = 0; i < countof(g_skipElementNameTable); i++)
+		{
+			const char* candidate = g_skipElementNameTable[i];
+			size_t length = strlen(candidate);
+
+			if ((size_t)(end - p) <= length ||
+				memcmp(p, candidate, length) != 0 ||
+				!isTagNameEnd(p[length]))
+				continue;
+
+			const char* tagEnd = (const char*)memchr(p + length, '>', end - p - length);
+			if (!tagEnd || tagEnd[-1] == '/') // truncated or empty element
+				break;
+
+			*name = candidate;
+			*nameLength = length;
+			return tagEnd + 1;
+		}
+	}
+}
+
+static
+const char*
+findCloseTag(
+	const char* p,
+	const char* end,
+	const char* name,
+	size_t nameLength
+	)
+{
+	size_t level = 0;
+
+	for (;;)
+	{
+		p = (const char*)memchr(p, '<', end - p);
+		if (!p)
+			return NULL;
+
+		bool isClose = p + 1 < end && p[1] == '/';
+		const char* nameStart = isClose ? p + 2 : p + 1;
+
+		if ((size_t)(end - nameStart) > nameLength &&
+			memcmp(nameStart, name, nameLength) == 0 &&
+			isTagNameEnd(nameStart[nameLength]))
+		{
+			if (isClose)
+			{
+				if (!level)
+					return p;
+
+				level--;
+			}
+			else
+			{
+				const char* tagEnd = (const char*)memchr(nameStart, '>', end - nameStart);
+				if (!tagEnd)
+					return NULL;
+
+				if (tagEnd[-1] != '/')
+					level++;
+			}
+		}
+
+		p++;
+	}
+}
+
 //..............................................................................
 
 DoxyXmlParser::DoxyXmlParser()
 {
 	m_module = NULL;
 	m_fileKind = DoxyXmlFileKind_Index;
+	m_flags = 0;
+	m_blockSize = DoxyXmlParser_DefaultBlockSize;
+	m_archive = NULL;
+	m_descriptionSource = NULL;
+	m_deferredDescription = NULL;
+	m_skippedSize = 0;
+	m_skipRequestEnd = -1;
 
 #if (_PRINT_XML)
 	m_indent = 0;
@@ -38,7 +159,247 @@ DoxyXmlParser::parseFile(
 	m_filePath = io::getFullFilePath(fileName);
 	m_baseDir = io::getDir(m_filePath);
 
-	return xml::ExpatParser<DoxyXmlParser>::parseFile(fileName);
+	if (blockSize != DoxyXmlParser_KeepBlockSize)
+		m_blockSize = blockSize;
+
+	return (m_flags & DoxyXmlParserFlag_Mmap) ?
+		parseMappedFile(fileName) :
+		xml::ExpatParser<DoxyXmlParser>::parseFile(fileName, m_blockSize);
+}
+
+#if (_AXL_OS_POSIX)
+
+bool
+DoxyXmlParser::parseMappedFile(const sl::StringRef& fileName)
+{
+	int fd = ::open(fileName.sz(), O_RDONLY);
+	if (fd == -1)
+	{
+		err::setLastSystemError();
+		return false;
+	}
+
+	struct stat st;
+	int result = ::fstat(fd, &st);
+	if (result == -1)
+	{
+		err::setLastSystemError();
+		::close(fd);
+		return false;
+	}
+
+	size_t size = st.st_size;
+	if (!size) // can't map an empty file; let expat report the error
+	{
+		::close(fd);
+		return parseBlocks(NULL, 0);
+	}
+
+	void* view = ::mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd); // the mapping holds its own reference
+
+	if (view == MAP_FAILED)
+	{
+		err::setLastSystemError();
+		return false;
+	}
+
+	::madvise(view, size, MADV_SEQUENTIAL);
+
+	bool result = parseBlocks((const char*)view, size);
+
+	::munmap(view, size); // compound files are parsed once -- drop pages now
+	return result;
+}
+
+#else
+
+bool
+DoxyXmlParser::parseMappedFile(const sl::StringRef& fileName)
+{
+	return xml::ExpatParser<DoxyXmlParser>::parseFile(fileName, m_blockSize);
+}
+
+#endif
+
+bool
+DoxyXmlParser::parseArchiveFile(
+	Module* module,
+	DoxyXmlArchive* archive,
+	DoxyXmlFileKind fileKind,
+	const sl::StringRef& path,
+	size_t blockSize
+	)
+{
+	m_module = module;
+	m_archive = archive;
+	m_fileKind = fileKind;
+	m_filePath = archive->getFileName() + "/" + path;
+	m_archiveFilePath = path;
+
+	size_t slash = path.reverseFind('/');
+	m_baseDir = slash != -1 ? path.getSubString(0, slash) : sl::StringRef();
+
+	if (blockSize != DoxyXmlParser_KeepBlockSize)
+		m_blockSize = blockSize;
+
+	DoxyXmlArchiveFile file;
+	bool result = archive->openFile(path, &file);
+	if (!result)
+		return false;
+
+	return parseBlocks(file.m_p, file.m_size);
+}
+
+bool
+DoxyXmlParser::parseDeferredDescription(Description* description)
+{
+	DescriptionSource* source = description->m_source;
+	ASSERT(source);
+
+	Module* module = source->m_module;
+	DoxyXmlArchiveFile* file = &module->m_cachedDescriptionFile;
+
+	if (module->m_cachedDescriptionSource != source)
+	{
+		// descriptions are exported compound by compound, so caching
+		// the last source file is enough
+
+		module->m_cachedDescriptionSource = NULL;
+		file->m_buffer.clear();
+
+		if (source->m_archive)
+		{
+			bool result = source->m_archive->openFile(source->m_filePath, file);
+			if (!result)
+				return false;
+		}
+		else
+		{
+			io::File diskFile;
+			bool result = diskFile.open(source->m_filePath, io::FileFlag_ReadOnly);
+			if (!result)
+				return false;
+
+			size_t size = (size_t)diskFile.getSize();
+			file->m_buffer.setCount(size);
+			if (diskFile.read(file->m_buffer.p(), size) != size)
+			{
+				err::setFormatStringError("error reading '%s'", source->m_filePath.sz());
+				return false;
+			}
+
+			file->m_p = file->m_buffer.cp();
+			file->m_size = size;
+		}
+
+		module->m_cachedDescriptionSource = source;
+	}
+
+	if (description->m_offset + description->m_length > file->m_size)
+	{
+		err::setFormatStringError("'%s' changed since it was parsed", source->m_filePath.sz());
+		return false;
+	}
+
+	module->m_loadedDescriptionCount++;
+
+	DoxyXmlParser parser;
+	parser.m_module = module;
+	parser.m_fileKind = DoxyXmlFileKind_Description;
+	parser.m_filePath = source->m_filePath;
+	parser.m_deferredDescription = description;
+	parser.pushCompound(source->m_compound);
+
+	return parser.parseBlocks(file->m_p + description->m_offset, description->m_length);
+}
+
+DescriptionSource*
+DoxyXmlParser::getDescriptionSource()
+{
+	Compound* compound = getCurrentCompound();
+	if (m_descriptionSource && m_descriptionSource->m_compound == compound)
+		return m_descriptionSource;
+
+	m_descriptionSource = AXL_MEM_NEW(DescriptionSource);
+	m_descriptionSource->m_module = m_module;
+	m_descriptionSource->m_compound = compound;
+	m_descriptionSource->m_archive = m_archive;
+	m_descriptionSource->m_filePath = m_archive ? m_archiveFilePath : m_filePath;
+	m_module->m_descriptionSourceList.insertTail(m_descriptionSource);
+	return m_descriptionSource;
+}
+
+bool
+DoxyXmlParser::pushDescriptionType(
+	Description* description,
+	const char* name,
+	const char** attributes
+	)
+{
+	return (m_flags & DoxyXmlParserFlag_DeferDescriptions) ?
+		pushType<DeferredDescriptionType>(description, name, attributes) :
+		pushType<DescriptionType>(description, name, attributes);
+}
+
+bool
+DoxyXmlParser::parseBlocks(
+	const char* p,
+	size_t size
+	)
+{
+	bool result = create();
+	if (!result)
+		return false;
+
+	m_skippedSize = 0;
+
+	if (!size)
+		return parse(p, 0, true);
+
+	bool canSkip = m_fileKind == DoxyXmlFileKind_Compound;
+
+	const char* begin = p;
+	const char* end = p + size;
+	while (p < end)
+	{
+		const char* sliceEnd = p + AXL_MIN(m_blockSize, (size_t)(end - p));
+		const char* skipName = NULL;
+		size_t skipNameLength = 0;
+
+		if (canSkip)
+		{
+			// cut the slice right after the start tag of the next skippable
+			// element so we can jump over its contents if a handler asks to
+
+			const char* tagEnd = findSkipCandidate(p, sliceEnd, end, &skipName, &skipNameLength);
+			if (tagEnd)
+				sliceEnd = tagEnd;
+		}
+
+		m_skipRequestEnd = -1;
+
+		result = parse(p, sliceEnd - p, sliceEnd >= end);
+		if (!result)
+			return false;
+
+		p = sliceEnd;
+
+		if (skipName && m_skipRequestEnd == (size_t)(p - begin) - m_skippedSize)
+		{
+			// expat will see an empty element: <name ...></name>
+
+			const char* closeTag = findCloseTag(p, end, skipName, skipNameLength);
+			if (closeTag)
+			{
+				m_skippedSize += closeTag - p;
+				p = closeTag;
+			}
+		}
+	}
+
+	m_module->m_skippedXmlSize += m_skippedSize;
+	return true;
 }
 
 void
@@ -89,6 +450,10 @@ DoxyXmlParser::onStartElement(
 		case ElemKind_DoxygenCompound:
 			pushType<DoxygenCompoundType>(name, attributes);
 			break;
+
+		default:
+			if (m_fileKind == DoxyXmlFileKind_Description)
+				pushType<DescriptionType>(m_deferredDescription, name, attributes);
 		}
 	}
 	else
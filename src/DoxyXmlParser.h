@@ -12,6 +12,7 @@
 #pragma once
 
 #include "DoxyXmlType.h"
+#include "DoxyXmlArchive.h"
 #include "Module.h"
 
 #define _PRINT_XML 0
@@ -22,6 +23,21 @@ enum DoxyXmlFileKind
 {
 	DoxyXmlFileKind_Index,
 	DoxyXmlFileKind_Compound,
+	DoxyXmlFileKind_Description, // a deferred description element
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+enum DoxyXmlParserFlag
+{
+	DoxyXmlParserFlag_Mmap              = 0x01, // feed expat directly from a file mapping
+	DoxyXmlParserFlag_DeferDescriptions = 0x02, // only record byte ranges of descriptions
+};
+
+enum
+{
+	DoxyXmlParser_DefaultBlockSize = 1 * 1024 * 1024, // 1M
+	DoxyXmlParser_KeepBlockSize    = 0, // for parse* calls: use getBlockSize()
 };
 
 // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
@@ -54,6 +70,15 @@ protected:
 	DoxyXmlFileKind m_fileKind;
 	sl::String m_filePath;
 	sl::String m_baseDir;
+	uint_t m_flags;
+	sl::String m_footnoteMemberPrefix;
+	size_t m_blockSize;
+	DoxyXmlArchive* m_archive;
+	sl::String m_archiveFilePath;
+	DescriptionSource* m_descriptionSource;
+	Description* m_deferredDescription;
+	size_t m_skippedSize; // raw bytes expat never saw (in the current file)
+	size_t m_skipRequestEnd; // expat byte index right after the start tag
 	sl::Array<TypeStackEntry> m_typeStack;
 	sl::Array<Compound*> m_compoundStack;
 
@@ -87,24 +112,117 @@ public:
 		return m_baseDir;
 	}
 
+	uint_t
+	getFlags()
+	{
+		return m_flags;
+	}
+
+	void
+	setFlags(uint_t flags)
+	{
+		m_flags = flags;
+	}
+
+	const sl::String&
+	getFootnoteMemberPrefix()
+	{
+		return m_footnoteMemberPrefix;
+	}
+
+	// group members with this name prefix are parsed in full (to become
+	// footnotes); all the other group members are just id references
+
+	void
+	setFootnoteMemberPrefix(const sl::StringRef& prefix)
+	{
+		m_footnoteMemberPrefix = prefix;
+	}
+
+	size_t
+	getBlockSize()
+	{
+		return m_blockSize;
+	}
+
+	DoxyXmlArchive*
+	getArchive()
+	{
+		return m_archive;
+	}
+
+	size_t
+	getCurrentByteIndex()
+	{
+		return (size_t)XML_GetCurrentByteIndex(m_h) + m_skippedSize;
+	}
+
+	size_t
+	getCurrentByteCount()
+	{
+		return XML_GetCurrentByteCount(m_h);
+	}
+
+	DescriptionSource*
+	getDescriptionSource();
+
+	// once the model is built, the handle table must not grow -- render
+	// threads read it without locking; so deferred descriptions only look
+	// handles up. DeferredRefScanType registered every <ref> of the range by
+	// the same id when the range was recorded, so the lookup can't miss and
+	// yields exactly the handle an eager parse would have assigned
+
+	size_t
+	getHandle(const sl::StringRef& id)
+	{
+		if (m_fileKind != DoxyXmlFileKind_Description)
+			return m_module->getHandle(id);
+
+		size_t handle = m_module->findHandle(id);
+		ASSERT(handle != -1 || id.isEmpty());
+		return handle;
+	}
+
+	// called from onStartElement handlers of ignored elements -- if the
+	// element is a known skippable one, its contents won't even be tokenized
+
+	void
+	requestSkip()
+	{
+		m_skipRequestEnd = (size_t)XML_GetCurrentByteIndex(m_h) + XML_GetCurrentByteCount(m_h);
+	}
+
 	bool
 	parseFile(
 		Module* module,
 		DoxyXmlFileKind fileKind,
 		const sl::StringRef& fileName,
-		size_t blockSize = -1
+		size_t blockSize = DoxyXmlParser_KeepBlockSize
 		);
 
 	bool
 	parseFile(
 		Module* module,
 		const sl::StringRef& fileName,
-		size_t blockSize = -1
+		size_t blockSize = DoxyXmlParser_KeepBlockSize
 		)
 	{
 		return parseFile(module, DoxyXmlFileKind_Index, fileName, blockSize);
 	}
 
+	bool
+	parseArchiveFile(
+		Module* module,
+		DoxyXmlArchive* archive,
+		DoxyXmlFileKind fileKind,
+		const sl::StringRef& path, // path inside the archive
+		size_t blockSize = DoxyXmlParser_KeepBlockSize
+		);
+
+	static
+	bool
+	parseDeferredDescription(Description* description);
+
 	void
 	clear();
 
@@ -144,6 +262,13 @@ public:
 		return type->create(this, context, name, attributes);
 	}
 
+	bool
+	pushDescriptionType(
+		Description* description,
+		const char* name,
+		const char** attributes
+		);
+
 	Compound*
 	getCurrentCompound()
 	{
@@ -163,6 +288,15 @@ public:
 	}
 
 protected:
+	bool
+	parseMappedFile(const sl::StringRef& fileName);
+
+	bool
+	parseBlocks(
+		const char* p,
+		size_t size
+		);
+
 	void
 	onStartElement(
 		const char* name,
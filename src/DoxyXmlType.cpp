@@ -96,13 +96,34 @@ DoxygenIndexType::onCompound(
 bool
 DoxygenIndexType::parseCompound(const char* refId)
 {
+	DoxyXmlParser parser;
+	parser.setFlags(m_parser->getFlags());
+	parser.setFootnoteMemberPrefix(m_parser->getFootnoteMemberPrefix());
+
+	DoxyXmlArchive* archive = m_parser->getArchive();
+	if (archive)
+	{
+		const sl::String& baseDir = m_parser->getBaseDir();
+		sl::String path = baseDir.isEmpty() ?
+			sl::String(refId) + ".xml" :
+			baseDir + "/" + refId + ".xml";
+
+		return parser.parseArchiveFile(
+			m_parser->getModule(),
+			archive,
+			DoxyXmlFileKind_Compound,
+			path,
+			m_parser->getBlockSize()
+			);
+	}
+
 	sl::String filePath = m_parser->getBaseDir() + "/" + refId + ".xml";
 
-	DoxyXmlParser parser;
 	return parser.parseFile(
 		m_parser->getModule(),
 		DoxyXmlFileKind_Compound,
-		filePath
+		filePath,
+		m_parser->getBlockSize()
 		);
 }
 
@@ -175,7 +196,7 @@ CompoundDefType::create(
 	module->m_compoundList.insertTail(m_compound);
 	parser->pushCompound(m_compound);
 
-	sl::StringHashTableIterator<Compound*> mapIt;
+	HandleEntry* handleEntry;
 
 	while (*attributes)
 	{
@@ -184,14 +205,18 @@ CompoundDefType::create(
 		{
 		case AttrKind_Id:
 			m_compound->m_id = attributes[1];
-			mapIt = module->m_compoundMap.visit(m_compound->m_id);
-			if (!mapIt->m_value)
+			m_compound->m_handle = module->getHandle(m_compound->m_id);
+			handleEntry = module->getHandleEntry(m_compound->m_handle);
+			if (!handleEntry)
+				break;
+
+			if (!handleEntry->m_compound)
 			{
-				mapIt->m_value = m_compound;
+				handleEntry->m_compound = m_compound;
 			}
 			else
 			{
-				Compound* prevCompound = mapIt->m_value;
+				Compound* prevCompound = handleEntry->m_compound;
 				fprintf(
 					stderr,
 					"%s: warning: duplicate compoud id: %s (%s: %s)\n",
@@ -204,7 +229,7 @@ CompoundDefType::create(
 				if (prevCompound->m_detailedDescription.isEmpty() && prevCompound->m_briefDescription.isEmpty())
 				{
 					fprintf(stderr, "  replacing old compound as it has no documentation\n");
-					mapIt->m_value = m_compound;
+					handleEntry->m_compound = m_compound;
 					prevCompound->m_isDuplicate = true;
 				}
 				else
@@ -306,8 +331,11 @@ CompoundDefType::onStartElement(
 		break;
 
 	case ElemKind_IncludedBy:
+		break;
+
 	case ElemKind_IncDepGraph:
 	case ElemKind_InvIncDepGraph:
+		m_parser->requestSkip();
 		break;
 
 	case ElemKind_InnerDir:
@@ -328,11 +356,11 @@ CompoundDefType::onStartElement(
 		break;
 
 	case ElemKind_BriefDescription:
-		m_parser->pushType<DescriptionType>(&m_compound->m_briefDescription, name, attributes);
+		m_parser->pushDescriptionType(&m_compound->m_briefDescription, name, attributes);
 		break;
 
 	case ElemKind_DetailedDescription:
-		m_parser->pushType<DescriptionType>(&m_compound->m_detailedDescription, name, attributes);
+		m_parser->pushDescriptionType(&m_compound->m_detailedDescription, name, attributes);
 		break;
 
 	case ElemKind_Location:
@@ -343,6 +371,7 @@ CompoundDefType::onStartElement(
 	case ElemKind_CollaborationGraph:
 	case ElemKind_ProgramListing:
 	case ElemKind_ListOfAllMembers:
+		m_parser->requestSkip();
 		break;
 	}
 
@@ -377,7 +406,8 @@ RefType::create(
 		switch (attrKind)
 		{
 		case AttrKind_RefId:
-			m_ref->m_id = attributes[1];
+			m_ref->m_id = m_parser->getModule()->intern(attributes[1]);
+			m_ref->m_handle = m_parser->getModule()->getHandle(m_ref->m_id);
 			break;
 
 		case AttrKind_ImportId:
@@ -470,7 +500,7 @@ MemberDefType::create(
 	m_member->m_parentCompound = parent;
 	parent->m_memberList.insertTail(m_member);
 
-	sl::StringHashTableIterator<Member*> mapIt;
+	HandleEntry* handleEntry;
 	while (*attributes)
 	{
 		AttrKind attrKind = AttrKindMap::findValue(attributes[0], AttrKind_Undefined);
@@ -482,17 +512,28 @@ MemberDefType::create(
 
 		case AttrKind_Id:
 			m_member->m_id = attributes[1];
+			m_member->m_handle = module->getHandle(m_member->m_id);
 			if (parent->m_compoundKind == CompoundKind_Group)
-				break; // doxy groups contain duplicated definitions of members
+			{
+				// doxy groups contain duplicated definitions of members -- the
+				// id is all GlobalNamespace::build needs (footnotes aside)
 
-			mapIt = module->m_memberMap.visit(m_member->m_id);
-			if (!mapIt->m_value)
+				m_isGroupRef = true;
+				module->m_groupMemberRefCount++;
+				break;
+			}
+
+			handleEntry = module->getHandleEntry(m_member->m_handle);
+			if (!handleEntry)
+				break;
+
+			if (!handleEntry->m_member)
 			{
-				mapIt->m_value = m_member;
+				handleEntry->m_member = m_member;
 			}
 			else
 			{
-				Member* prevMember = mapIt->m_value;
+				Member* prevMember = handleEntry->m_member;
 				fprintf(
 					stderr,
 					"%s: warning: duplicate member id %s (%s: %s)\n",
@@ -505,7 +546,7 @@ MemberDefType::create(
 				if (prevMember->m_detailedDescription.isEmpty() && prevMember->m_briefDescription.isEmpty())
 				{
 					fprintf(stderr, "  replacing old member as it has no documentation\n");
-					mapIt->m_value = m_member;
+					handleEntry->m_member = m_member;
 					prevMember->m_flags |= MemberFlag_Duplicate;
 				}
 				else
@@ -685,6 +726,20 @@ MemberDefType::onStartElement(
 	sl::BoxIterator<sl::String> stringIt;
 
 	ElemKind elemKind = ElemKindMap::findValue(name, ElemKind_Undefined);
+
+	if (m_isGroupRef && elemKind != ElemKind_Name)
+	{
+		// footnotes are rendered from the group itself, so these need the full
+		// payload (the name precedes descriptions and location in doxygen XML)
+
+		const sl::String& footnotePrefix = m_parser->getFootnoteMemberPrefix();
+		if (footnotePrefix.isEmpty() || !m_member->m_name.isPrefix(footnotePrefix))
+			return true; // the element and its contents are ignored
+
+		m_isGroupRef = false;
+		m_parser->getModule()->m_groupMemberRefCount--;
+	}
+
 	switch (elemKind)
 	{
 	case ElemKind_Includes:
@@ -741,15 +796,15 @@ MemberDefType::onStartElement(
 		break;
 
 	case ElemKind_BriefDescription:
-		m_parser->pushType<DescriptionType>(&m_member->m_briefDescription, name, attributes);
+		m_parser->pushDescriptionType(&m_member->m_briefDescription, name, attributes);
 		break;
 
 	case ElemKind_DetailedDescription:
-		m_parser->pushType<DescriptionType>(&m_member->m_detailedDescription, name, attributes);
+		m_parser->pushDescriptionType(&m_member->m_detailedDescription, name, attributes);
 		break;
 
 	case ElemKind_InBodyDescription:
-		m_parser->pushType<DescriptionType>(&m_member->m_inBodyDescription, name, attributes);
+		m_parser->pushDescriptionType(&m_member->m_inBodyDescription, name, attributes);
 		break;
 
 	case ElemKind_Location:
@@ -811,6 +866,97 @@ DescriptionType::onStartElement(
 
 //..............................................................................
 
+bool
+DeferredDescriptionType::create(
+	DoxyXmlParser* parser,
+	Description* description,
+	const char* name,
+	const char** attributes
+	)
+{
+	m_parser = parser;
+	m_description = description;
+	m_description->m_source = parser->getDescriptionSource();
+	m_description->m_offset = parser->getCurrentByteIndex();
+	m_description->m_length = parser->getCurrentByteCount(); // adjusted in onEndElement
+	parser->getModule()->m_deferredDescriptionCount++;
+	return true;
+}
+
+bool
+DeferredDescriptionType::onStartElement(
+	const char* name,
+	const char** attributes
+	)
+{
+	m_description->m_hasContent = true;
+	return m_parser->pushType<DeferredRefScanType>(m_description, name, attributes);
+}
+
+bool
+DeferredDescriptionType::onCharacterData(
+	const char* string,
+	size_t length
+	)
+{
+	const char* end = string + length;
+	for (; string < end; string++)
+		if (!isspace((uchar_t)*string))
+		{
+			m_description->m_hasContent = true;
+			break;
+		}
+
+	return true;
+}
+
+bool
+DeferredDescriptionType::onEndElement(const char* name)
+{
+	// for <briefdescription/> the byte count of the end event is zero
+
+	size_t end = m_parser->getCurrentByteIndex() + m_parser->getCurrentByteCount();
+	if (end > m_description->m_offset + m_description->m_length)
+		m_description->m_length = end - m_description->m_offset;
+
+	return true;
+}
+
+//..............................................................................
+
+bool
+DeferredRefScanType::create(
+	DoxyXmlParser* parser,
+	Description* description,
+	const char* name,
+	const char** attributes
+	)
+{
+	m_parser = parser;
+	m_description = description;
+
+	if (strcmp(name, "ref") != 0)
+		return true;
+
+	while (*attributes)
+	{
+		if (!strcmp(attributes[0], "refid"))
+		{
+			size_t handle = parser->getModule()->getHandle(attributes[1]);
+			if (handle != -1)
+				m_description->m_refHandleArray.append(handle);
+
+			break;
+		}
+
+		attributes += 2;
+	}
+
+	return true;
+}
+
+//..............................................................................
+
 bool
 LocationType::create(
 	DoxyXmlParser* parser,
@@ -826,7 +972,7 @@ LocationType::create(
 		switch (attrKind)
 		{
 		case AttrKind_File:
-			location->m_file = attributes[1];
+			location->m_file = parser->getModule()->intern(attributes[1]);
 			break;
 
 		case AttrKind_Line:
@@ -838,7 +984,7 @@ LocationType::create(
 			break;
 
 		case AttrKind_BodyFile:
-			location->m_bodyFile = attributes[1];
+			location->m_bodyFile = parser->getModule()->intern(attributes[1]);
 			break;
 
 		case AttrKind_BodyStart:
@@ -868,7 +1014,7 @@ DocSectionBlockType::create(
 {
 	m_parser = parser;
 	m_sectionBlock = AXL_MEM_NEW(DocSectionBlock);
-	m_sectionBlock->m_blockKind = name;
+	m_sectionBlock->m_blockKind = m_parser->getModule()->intern(name);
 	list->insertTail(m_sectionBlock);
 
 	while (*attributes)
@@ -933,7 +1079,7 @@ EnumValueType::create(
 	m_enumValue->m_parentEnum = member;
 	member->m_enumValueList.insertTail(m_enumValue);
 
-	sl::StringHashTableIterator<EnumValue*> mapIt;
+	HandleEntry* handleEntry;
 	while (*attributes)
 	{
 		AttrKind attrKind = AttrKindMap::findValue(attributes[0], AttrKind_Undefined);
@@ -941,18 +1087,22 @@ EnumValueType::create(
 		{
 		case AttrKind_Id:
 			m_enumValue->m_id = attributes[1];
+			m_enumValue->m_handle = module->getHandle(m_enumValue->m_id);
 			ASSERT(member->m_parentCompound);
 			if (member->m_parentCompound->m_compoundKind == CompoundKind_Group)
 				break; // doxy groups contain duplicated definitions of members
 
-			mapIt = module->m_enumValueMap.visit(m_enumValue->m_id);
-			if (!mapIt->m_value)
+			handleEntry = module->getHandleEntry(m_enumValue->m_handle);
+			if (!handleEntry)
+				break;
+
+			if (!handleEntry->m_enumValue)
 			{
-				mapIt->m_value = m_enumValue;
+				handleEntry->m_enumValue = m_enumValue;
 			}
 			else
 			{
-				EnumValue* prevEnumValue = mapIt->m_value;
+				EnumValue* prevEnumValue = handleEntry->m_enumValue;
 				fprintf(
 					stderr,
 					"%s: warning: duplicate enum value id %s (%s)\n",
@@ -964,7 +1114,7 @@ EnumValueType::create(
 				if (prevEnumValue->m_detailedDescription.isEmpty() && prevEnumValue->m_briefDescription.isEmpty())
 				{
 					fprintf(stderr, "  replacing old enum value as it has no documentation\n");
-					mapIt->m_value = m_enumValue;
+					handleEntry->m_enumValue = m_enumValue;
 					prevEnumValue->m_isDuplicate = true;
 				}
 				else
@@ -1004,11 +1154,11 @@ EnumValueType::onStartElement(
 		break;
 
 	case ElemKind_BriefDescription:
-		m_parser->pushType<DescriptionType>(&m_enumValue->m_briefDescription, name, attributes);
+		m_parser->pushDescriptionType(&m_enumValue->m_briefDescription, name, attributes);
 		break;
 
 	case ElemKind_DetailedDescription:
-		m_parser->pushType<DescriptionType>(&m_enumValue->m_detailedDescription, name, attributes);
+		m_parser->pushDescriptionType(&m_enumValue->m_detailedDescription, name, attributes);
 		break;
 	}
 
@@ -1098,7 +1248,7 @@ ParamType::onStartElement(
 		break;
 
 	case ElemKind_BriefDescription:
-		m_parser->pushType<DescriptionType>(&m_param->m_briefDescription, name, attributes);
+		m_parser->pushDescriptionType(&m_param->m_briefDescription, name, attributes);
 		break;
 	}
 
@@ -1142,6 +1292,18 @@ LinkedTextType::onStartElement(
 	return true;
 }
 
+void
+LinkedTextType::onPopType()
+{
+	// fragments of type text ("const", "void", "size_t", ...) repeat a lot
+
+	Module* module = m_parser->getModule();
+
+	sl::Iterator<RefText> it = m_linkedText->m_refTextList.getHead();
+	for (; it; it++)
+		it->m_text = module->intern(it->m_text);
+}
+
 //..............................................................................
 
 bool
@@ -1162,7 +1324,8 @@ RefTextType::create(
 		switch (attrKind)
 		{
 		case AttrKind_RefId:
-			m_refText->m_id = attributes[1];
+			m_refText->m_id = m_parser->getModule()->intern(attributes[1]);
+			m_refText->m_handle = m_parser->getHandle(m_refText->m_id);
 			break;
 
 		case AttrKind_KindRef:
@@ -1196,7 +1359,7 @@ DocParaType::create(
 {
 	m_parser = parser;
 	m_paragraphBlock = AXL_MEM_NEW(DocBlock);
-	m_paragraphBlock->m_blockKind = name;
+	m_paragraphBlock->m_blockKind = m_parser->getModule()->intern(name);
 	blockList->insertTail(m_paragraphBlock);
 
 	m_textBlock = AXL_MEM_NEW(DocBlock);
@@ -1260,7 +1423,7 @@ DocRefTextType::create(
 	m_parser = parser;
 	m_refBlock = AXL_MEM_NEW(DocRefBlock);
 	m_refBlock->m_module = m_parser->getModule();
-	m_refBlock->m_blockKind = name;
+	m_refBlock->m_blockKind = m_parser->getModule()->intern(name);
 	list->insertTail(m_refBlock);
 
 	while (*attributes)
@@ -1269,7 +1432,8 @@ DocRefTextType::create(
 		switch (attrKind)
 		{
 		case AttrKind_RefId:
-			m_refBlock->m_id = attributes[1];
+			m_refBlock->m_id = m_parser->getModule()->intern(attributes[1]);
+			m_refBlock->m_handle = m_parser->getHandle(m_refBlock->m_id);
 			break;
 
 		case AttrKind_KindRef:
@@ -1299,7 +1463,7 @@ DocAnchorType::create(
 {
 	m_parser = parser;
 	m_anchorBlock = AXL_MEM_NEW(DocAnchorBlock);
-	m_anchorBlock->m_blockKind = name;
+	m_anchorBlock->m_blockKind = m_parser->getModule()->intern(name);
 	list->insertTail(m_anchorBlock);
 
 	while (*attributes)
@@ -1335,7 +1499,7 @@ DocImageType::create(
 {
 	m_parser = parser;
 	m_imageBlock = AXL_MEM_NEW(DocImageBlock);
-	m_imageBlock->m_blockKind = name;
+	m_imageBlock->m_blockKind = m_parser->getModule()->intern(name);
 	list->insertTail(m_imageBlock);
 
 	while (*attributes)
@@ -1378,7 +1542,7 @@ DocUlinkType::create(
 {
 	m_parser = parser;
 	m_ulinkBlock = AXL_MEM_NEW(DocUlinkBlock);
-	m_ulinkBlock->m_blockKind = name;
+	m_ulinkBlock->m_blockKind = m_parser->getModule()->intern(name);
 	list->insertTail(m_ulinkBlock);
 
 	while (*attributes)
@@ -1411,7 +1575,7 @@ DocHeadingType::create(
 {
 	m_parser = parser;
 	m_headingBlock = AXL_MEM_NEW(DocHeadingBlock);
-	m_headingBlock->m_blockKind = name;
+	m_headingBlock->m_blockKind = m_parser->getModule()->intern(name);
 	list->insertTail(m_headingBlock);
 
 	while (*attributes)
@@ -1443,7 +1607,7 @@ DocSimpleSectionType::create(
 {
 	m_parser = parser;
 	m_sectionBlock = AXL_MEM_NEW(DocSimpleSectionBlock);
-	m_sectionBlock->m_blockKind = name;
+	m_sectionBlock->m_blockKind = m_parser->getModule()->intern(name);
 	list->insertTail(m_sectionBlock);
 
 	while (*attributes)
@@ -658,11 +658,13 @@ protected:
 
 protected:
 	Member* m_member;
+	bool m_isGroupRef; // a duplicate inside a group: only id and name are parsed
 
 public:
 	MemberDefType()
 	{
 		m_member = NULL;
+		m_isGroupRef = false;
 	}
 
 	bool
@@ -759,6 +761,84 @@ public:
 
 //..............................................................................
 
+// records the byte range of a description element and whether it has any
+// content at all -- children are skipped (see DoxyXmlParser::onStartElement)
+
+class DeferredDescriptionType: public DoxyXmlType
+{
+protected:
+	Description* m_description;
+
+public:
+	DeferredDescriptionType()
+	{
+		m_description = NULL;
+	}
+
+	bool
+	create(
+		DoxyXmlParser* parser,
+		Description* description,
+		const char* name,
+		const char** attributes
+		);
+
+	virtual
+	bool
+	onStartElement(
+		const char* name,
+		const char** attributes
+		);
+
+	virtual
+	bool
+	onEndElement(const char* name);
+
+	virtual
+	bool
+	onCharacterData(
+		const char* string,
+		size_t length
+		);
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+// walks the elements of a deferred description and only records the handles
+// of <ref> targets (so the used-by index doesn't depend on deferral)
+
+class DeferredRefScanType: public DoxyXmlType
+{
+protected:
+	Description* m_description;
+
+public:
+	DeferredRefScanType()
+	{
+		m_description = NULL;
+	}
+
+	bool
+	create(
+		DoxyXmlParser* parser,
+		Description* description,
+		const char* name,
+		const char** attributes
+		);
+
+	virtual
+	bool
+	onStartElement(
+		const char* name,
+		const char** attributes
+		)
+	{
+		return m_parser->pushType<DeferredRefScanType>(m_description, name, attributes);
+	}
+};
+
+//..............................................................................
+
 class DocSectionBlockType: public DoxyXmlType
 {
 protected:
@@ -1022,6 +1102,10 @@ public:
 		m_refText->m_text.append(string, length);
 		return true;
 	}
+
+	virtual
+	void
+	onPopType();
 };
 
 //..............................................................................
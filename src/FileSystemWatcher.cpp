@@ -0,0 +1,211 @@
+//..............................................................................
+//
+//  This file is part of the Doxyrest toolkit.
+//
+//  Doxyrest is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/doxyrest/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "FileSystemWatcher.h"
+
+#if (_AXL_OS_LINUX)
+#	include <sys/inotify.h>
+#	include <poll.h>
+#	include <unistd.h>
+#endif
+
+//..............................................................................
+
+#if (_AXL_OS_LINUX)
+
+enum
+{
+	FileSystemWatcherMask =
+		IN_CLOSE_WRITE |
+		IN_CREATE |
+		IN_DELETE |
+		IN_MOVED_FROM |
+		IN_MOVED_TO |
+		IN_DELETE_SELF |
+		IN_MOVE_SELF,
+};
+
+bool
+FileSystemWatcher::open()
+{
+	close();
+
+	m_fd = inotify_init1(IN_CLOEXEC);
+	if (m_fd == -1)
+	{
+		err::setLastSystemError();
+		return false;
+	}
+
+	return true;
+}
+
+void
+FileSystemWatcher::close()
+{
+	if (m_fd == -1)
+		return;
+
+	::close(m_fd); // closing the descriptor also removes all the watches
+	m_fd = -1;
+	m_dirList.clear();
+	m_wdArray.clear();
+}
+
+bool
+FileSystemWatcher::addDir(const sl::StringRef& dir)
+{
+	ASSERT(m_fd != -1);
+
+	sl::String path = !dir.isEmpty() ? dir : ".";
+
+	sl::ConstBoxIterator<sl::String> it = m_dirList.getHead();
+	for (; it; it++)
+		if (*it == path)
+			return true;
+
+	int wd = inotify_add_watch(m_fd, path.sz(), FileSystemWatcherMask);
+	if (wd == -1)
+	{
+		err::setFormatStringError("can't watch '%s': %s", path.sz(), strerror(errno));
+		return false;
+	}
+
+	m_dirList.insertTail(path);
+	m_wdArray.append(wd);
+	return true;
+}
+
+void
+FileSystemWatcher::addChangedDir(
+	sl::BoxList<sl::String>* changedDirList,
+	int wd
+	)
+{
+	sl::ConstBoxIterator<sl::String> it = m_dirList.getHead();
+	for (size_t i = 0; it; it++, i++)
+	{
+		if (m_wdArray[i] != wd)
+			continue;
+
+		sl::ConstBoxIterator<sl::String> it2 = changedDirList->getHead();
+		for (; it2; it2++)
+			if (*it2 == *it)
+				return;
+
+		changedDirList->insertTail(*it);
+		return;
+	}
+}
+
+bool
+FileSystemWatcher::wait(
+	uint_t settleTime,
+	sl::String* fileName,
+	sl::BoxList<sl::String>* changedDirList
+	)
+{
+	ASSERT(m_fd != -1);
+
+	if (changedDirList)
+		changedDirList->clear();
+
+	uint64_t buffer[2 * 1024]; // inotify_event must be properly aligned
+	bool isChanged = false;
+
+	for (;;)
+	{
+		if (isChanged)
+		{
+			pollfd pfd = { m_fd, POLLIN, 0 };
+			int result = poll(&pfd, 1, settleTime);
+			if (result == 0) // settled
+				return true;
+
+			if (result < 0)
+			{
+				if (errno == EINTR)
+					continue;
+
+				err::setLastSystemError();
+				return false;
+			}
+		}
+
+		ssize_t size = read(m_fd, buffer, sizeof(buffer)); // blocks until the first change
+		if (size <= 0)
+		{
+			if (size < 0 && errno == EINTR)
+				continue;
+
+			err::setLastSystemError();
+			return false;
+		}
+
+		if (!isChanged && fileName)
+		{
+			const inotify_event* event = (const inotify_event*)buffer;
+			*fileName = event->len ? event->name : "";
+		}
+
+		if (changedDirList)
+		{
+			const char* p = (const char*)buffer;
+			const char* end = p + size;
+
+			while (p < end)
+			{
+				const inotify_event* event = (const inotify_event*)p;
+				addChangedDir(changedDirList, event->wd);
+				p += sizeof(inotify_event) + event->len;
+			}
+		}
+
+		isChanged = true;
+	}
+}
+
+#else
+
+bool
+FileSystemWatcher::open()
+{
+	err::setError("watching directories is not supported on this platform");
+	return false;
+}
+
+void
+FileSystemWatcher::close()
+{
+}
+
+bool
+FileSystemWatcher::addDir(const sl::StringRef& dir)
+{
+	err::setError("watching directories is not supported on this platform");
+	return false;
+}
+
+bool
+FileSystemWatcher::wait(
+	uint_t settleTime,
+	sl::String* fileName,
+	sl::BoxList<sl::String>* changedDirList
+	)
+{
+	err::setError("watching directories is not supported on this platform");
+	return false;
+}
+
+#endif
+
+//..............................................................................
@@ -0,0 +1,90 @@
+//..............................................................................
+//
+//  This file is part of the Doxyrest toolkit.
+//
+//  Doxyrest is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/doxyrest/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+//..............................................................................
+
+// watches a set of (non-recursive) directories for modifications; only
+// implemented on Linux (inotify)
+
+class FileSystemWatcher
+{
+protected:
+	int m_fd;
+	sl::BoxList<sl::String> m_dirList;
+	sl::Array<int> m_wdArray; // watch descriptors, in the order of m_dirList
+
+public:
+	FileSystemWatcher()
+	{
+		m_fd = -1;
+	}
+
+	~FileSystemWatcher()
+	{
+		close();
+	}
+
+	static
+	bool
+	isSupported()
+	{
+#if (_AXL_OS_LINUX)
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	bool
+	isOpen()
+	{
+		return m_fd != -1;
+	}
+
+	const sl::BoxList<sl::String>&
+	getDirList()
+	{
+		return m_dirList;
+	}
+
+	bool
+	open();
+
+	void
+	close();
+
+	bool
+	addDir(const sl::StringRef& dir);
+
+	// blocks until something changes in any of the directories, then waits
+	// until there are no more changes for settleTime milliseconds (so a
+	// Doxygen pass re-writing hundreds of files triggers a single update);
+	// fileName is the first changed file, changedDirList gets every directory
+	// with changes (once)
+
+	bool
+	wait(
+		uint_t settleTime,
+		sl::String* fileName = NULL,
+		sl::BoxList<sl::String>* changedDirList = NULL
+		);
+
+protected:
+	void
+	addChangedDir(
+		sl::BoxList<sl::String>* changedDirList,
+		int wd
+		);
+};
+
+//..............................................................................
@@ -0,0 +1,201 @@
+//..............................................................................
+//
+//  This file is part of the Doxyrest toolkit.
+//
+//  Doxyrest is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/doxyrest/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "GenerationPlan.h"
+
+//..............................................................................
+
+bool
+GenerationPlan::addJob(
+	size_t depth,
+	const sl::StringRef& targetFileName,
+	const sl::StringRef& frameFileName,
+	const sl::StringRef& argIdList
+	)
+{
+	size_t index = m_jobArray.getCount();
+
+	// the parent is the closest preceding job one level up
+
+	size_t parentIndex = index - 1;
+	while (parentIndex != -1 && m_jobArray[parentIndex]->m_depth >= depth)
+		parentIndex = m_jobArray[parentIndex]->m_parentIndex;
+
+	size_t parentDepth = parentIndex != -1 ? m_jobArray[parentIndex]->m_depth : -1;
+	if (depth != parentDepth + 1)
+	{
+		err::setFormatStringError("invalid depth %d of plan record #%d", (int)depth, (int)index + 1);
+		return false;
+	}
+
+	GenerationJob* job = AXL_MEM_NEW(GenerationJob);
+	job->m_depth = depth;
+	job->m_targetFileName = targetFileName;
+	job->m_frameFileName = frameFileName;
+	job->m_argIdList = argIdList;
+	job->m_parentIndex = parentIndex;
+	job->m_endIndex = index + 1;
+	m_jobList.insertTail(job);
+	m_jobArray.append(job);
+
+	for (size_t i = parentIndex; i != -1; i = m_jobArray[i]->m_parentIndex)
+		m_jobArray[i]->m_endIndex = index + 1;
+
+	return true;
+}
+
+void
+GenerationPlan::assignShard(
+	size_t shardIndex,
+	size_t shardCount
+	)
+{
+	size_t count = m_jobArray.getCount();
+	for (size_t i = 0; i < count; i++)
+	{
+		GenerationJob* job = m_jobArray[i];
+		job->m_isOwned = shardCount && i % shardCount == shardIndex;
+		job->m_isNeeded = false;
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		if (!m_jobArray[i]->m_isOwned)
+			continue;
+
+		size_t j = i;
+		while (j != -1 && !m_jobArray[j]->m_isNeeded)
+		{
+			m_jobArray[j]->m_isNeeded = true;
+			j = m_jobArray[j]->m_parentIndex;
+		}
+	}
+}
+
+bool
+GenerationPlan::read(const sl::StringRef& fileName)
+{
+	clear();
+
+	io::File file;
+	bool result = file.open(fileName, io::FileFlag_ReadOnly);
+	if (!result)
+		return false;
+
+	size_t size = (size_t)file.getSize();
+
+	sl::Array<char> buffer;
+	buffer.setCount(size);
+	if (file.read(buffer.p(), size) != size)
+	{
+		err::setFormatStringError("error reading '%s'", fileName.sz());
+		return false;
+	}
+
+	const char* p = buffer.cp();
+	const char* end = p + size;
+
+	for (size_t lineNumber = 1; p < end; lineNumber++)
+	{
+		const char* eol = (const char*)memchr(p, '\n', end - p);
+		if (!eol)
+			eol = end;
+
+		sl::StringRef line(p, eol > p && eol[-1] == '\r' ? eol - p - 1 : eol - p);
+		p = eol + 1;
+
+		if (lineNumber == 1)
+		{
+			sl::String signature = sl::formatString(
+				"%s %d",
+				DOXYREST_PLAN_SIGNATURE,
+				GenerationPlanVersion_Current
+				);
+
+			if (line != signature)
+			{
+				err::setFormatStringError("'%s' is not a doxyrest plan (or has an unsupported version)", fileName.sz());
+				return false;
+			}
+
+			continue;
+		}
+
+		if (line.isEmpty())
+			continue;
+
+		size_t i = line.find('\t');
+		size_t j = i != -1 ? line.find('\t', i + 1) : -1;
+		size_t k = j != -1 ? line.find('\t', j + 1) : -1;
+		if (k == -1)
+		{
+			err::setFormatStringError("%s(%d): invalid plan record", fileName.sz(), (int)lineNumber);
+			return false;
+		}
+
+		size_t depth = strtoul(line.getSubString(0, i).sz(), NULL, 10);
+
+		result = addJob(
+			depth,
+			line.getSubString(i + 1, j - i - 1),
+			line.getSubString(j + 1, k - j - 1),
+			line.getSubString(k + 1)
+			);
+
+		if (!result)
+		{
+			err::setFormatStringError("%s(%d): %s", fileName.sz(), (int)lineNumber, err::getLastErrorDescription().sz());
+			return false;
+		}
+	}
+
+	if (buffer.isEmpty())
+	{
+		err::setFormatStringError("'%s' is empty", fileName.sz());
+		return false;
+	}
+
+	return true;
+}
+
+bool
+GenerationPlan::write(const sl::StringRef& fileName)
+{
+	sl::String string;
+	string.format("%s %d\n", DOXYREST_PLAN_SIGNATURE, GenerationPlanVersion_Current);
+
+	sl::ConstIterator<GenerationJob> it = m_jobList.getHead();
+	for (; it; it++)
+		string.appendFormat(
+			"%d\t%s\t%s\t%s\n",
+			(int)it->m_depth,
+			it->m_targetFileName.sz(),
+			it->m_frameFileName.sz(),
+			it->m_argIdList.sz()
+			);
+
+	io::File file;
+	bool result = file.open(fileName, io::FileFlag_Clear);
+	if (!result)
+		return false;
+
+	size_t size = file.write(string.cp(), string.getLength());
+	if (size != string.getLength())
+	{
+		err::setFormatStringError("error writing '%s'", fileName.sz());
+		return false;
+	}
+
+	return true;
+}
+
+//..............................................................................
@@ -0,0 +1,110 @@
+//..............................................................................
+//
+//  This file is part of the Doxyrest toolkit.
+//
+//  Doxyrest is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/doxyrest/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+//..............................................................................
+
+// plan file layout (text, one record per line, fields are tab-separated):
+//
+//   doxyrest-plan <version>
+//   <depth> <target-file-name> <frame-file-name> <space-separated-argument-ids>
+//   ...
+//
+// each record describes a generateFile call, in the order of calls; depth is
+// 0 for calls made by the master frame, 1 for calls made by files generated
+// from the master frame, and so on. records of the files generated by a file
+// immediately follow its own record
+
+#define DOXYREST_PLAN_SIGNATURE "doxyrest-plan"
+
+enum
+{
+	GenerationPlanVersion_Current = 2,
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+struct GenerationJob: sl::ListLink
+{
+	size_t m_depth;
+	sl::String m_targetFileName;
+	sl::String m_frameFileName;
+	sl::String m_argIdList; // ids of table arguments; "-" for arguments without ids
+
+	size_t m_parentIndex; // -1 for depth 0
+	size_t m_endIndex;    // index of the first job after the nested ones
+	bool m_isOwned;       // written by this shard
+	bool m_isNeeded;      // owned or has owned nested jobs
+
+	GenerationJob()
+	{
+		m_depth = 0;
+		m_parentIndex = -1;
+		m_endIndex = 0;
+		m_isOwned = false;
+		m_isNeeded = false;
+	}
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+class GenerationPlan
+{
+protected:
+	sl::List<GenerationJob> m_jobList;
+	sl::Array<GenerationJob*> m_jobArray;
+
+public:
+	size_t
+	getJobCount()
+	{
+		return m_jobArray.getCount();
+	}
+
+	const GenerationJob*
+	getJob(size_t i)
+	{
+		return i < m_jobArray.getCount() ? m_jobArray[i] : NULL;
+	}
+
+	void
+	clear()
+	{
+		m_jobList.clear();
+		m_jobArray.clear();
+	}
+
+	bool
+	addJob(
+		size_t depth,
+		const sl::StringRef& targetFileName,
+		const sl::StringRef& frameFileName,
+		const sl::StringRef& argIdList
+		);
+
+	// assigns jobs to shards round-robin; jobs of other shards are still
+	// needed (rendered, but not written) if they have nested jobs of this shard
+
+	void
+	assignShard(
+		size_t shardIndex,
+		size_t shardCount
+		);
+
+	bool
+	read(const sl::StringRef& fileName);
+
+	bool
+	write(const sl::StringRef& fileName);
+};
+
+//..............................................................................
@@ -13,18 +13,40 @@
 #include "Generator.h"
 #include "Module.h"
 
+#include <chrono>
+
+#define DOXYREST_CONFIG_GLOBALS_KEY "doxyrest.ConfigGlobals" // Lua registry
+
 //..............................................................................
 
+static
+void
+pushGlobalTable(lua_State* h)
+{
+#if (LUA_VERSION_NUM < 502)
+	lua_pushvalue(h, LUA_GLOBALSINDEX);
+#else
+	lua_pushglobaltable(h);
+#endif
+}
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
 bool
-Generator::create(const CmdLine* cmdLine)
+Generator::create(
+	const CmdLine* cmdLine,
+	const sl::StringRef& configFileName
+	)
 {
 	bool result = m_stringTemplate.create();
 	if (!result)
 		return false;
 
-	if (!cmdLine->m_configFileName.isEmpty())
+	applyLuaCompatShims();
+
+	if (!configFileName.isEmpty())
 	{
-		result = m_stringTemplate.m_luaState.doFile(cmdLine->m_configFileName);
+		result = m_stringTemplate.m_luaState.doFile(configFileName);
 		if (!result)
 			return false;
 	}
@@ -74,18 +96,282 @@ Generator::create(const CmdLine* cmdLine)
 	if (m_outputFileName.isEmpty())
 		m_outputFileName = g_defaultOutputFileName;
 
+	sl::String outputArchiveFileName = !cmdLine->m_outputArchiveFileName.isEmpty() ?
+		cmdLine->m_outputArchiveFileName :
+		m_stringTemplate.m_luaState.getGlobalString("OUTPUT_ARCHIVE");
+
+	if (!outputArchiveFileName.isEmpty())
+	{
+		result = m_tarOutputSink.open(outputArchiveFileName);
+		if (!result)
+			return false;
+
+		m_outputSink = &m_tarOutputSink;
+	}
+
+	if (cmdLine->m_flags & CmdLineFlag_Watch)
+		m_dirOutputSink.setUnchangedSkipped(true);
+
+	m_isMemoryStatsEnabled = (cmdLine->m_flags & CmdLineFlag_Stats) != 0;
+
+	m_searchIndexDir = m_stringTemplate.m_luaState.getGlobalString("SEARCH_INDEX_DIR");
+
+	m_planFileName = cmdLine->m_planFileName;
+	if (!m_planFileName.isEmpty())
+	{
+		if (cmdLine->m_shardCount)
+		{
+			m_mode = GeneratorMode_Shard;
+			m_shardIndex = cmdLine->m_shardIndex;
+			m_shardCount = cmdLine->m_shardCount;
+		}
+		else if (cmdLine->m_flags & CmdLineFlag_Merge)
+		{
+			m_mode = GeneratorMode_Merge;
+		}
+		else
+		{
+			m_mode = GeneratorMode_Plan;
+		}
+
+		if (m_mode != GeneratorMode_Plan)
+		{
+			result = m_plan.read(m_planFileName);
+			if (!result)
+				return false;
+
+			// the merge run owns no jobs, so it skips all of them
+
+			if (m_mode == GeneratorMode_Shard)
+				m_plan.assignShard(m_shardIndex, m_shardCount);
+			else
+				m_plan.assignShard(0, 0);
+		}
+	}
+
+	result = applyLuaGcConfig();
+	if (!result)
+		return false;
+
+	saveConfigGlobals();
+	recordLuaHeapSize("configuration");
+	return true;
+}
+
+void
+Generator::setConfigValue(
+	const sl::StringRef& name,
+	const sl::StringRef& value
+	)
+{
+	lua_State* h = m_stringTemplate.m_luaState;
+
+	m_stringTemplate.m_luaState.setGlobalString(name, value);
+
+	lua_getfield(h, LUA_REGISTRYINDEX, DOXYREST_CONFIG_GLOBALS_KEY);
+	if (lua_istable(h, -1))
+	{
+		lua_pushlstring(h, name.cp(), name.getLength());
+		lua_pushlstring(h, value.cp(), value.getLength());
+		lua_rawset(h, -3);
+	}
+
+	lua_pop(h, 1);
+}
+
+void
+Generator::saveConfigGlobals()
+{
+	lua_State* h = m_stringTemplate.m_luaState;
+
+	lua_newtable(h);
+	pushGlobalTable(h);
+
+	lua_pushnil(h);
+	while (lua_next(h, -2))
+	{
+		lua_pushvalue(h, -2);
+		lua_insert(h, -2);
+		lua_rawset(h, -5); // snapshot[key] = value; the key stays for lua_next
+	}
+
+	lua_pop(h, 1);
+	lua_setfield(h, LUA_REGISTRYINDEX, DOXYREST_CONFIG_GLOBALS_KEY);
+}
+
+void
+Generator::resetFrameGlobals()
+{
+	lua_State* h = m_stringTemplate.m_luaState;
+
+	lua_getfield(h, LUA_REGISTRYINDEX, DOXYREST_CONFIG_GLOBALS_KEY);
+	if (!lua_istable(h, -1))
+	{
+		lua_pop(h, 1);
+		return;
+	}
+
+	pushGlobalTable(h);
+
+	// clearing existing fields during traversal is allowed
+
+	lua_pushnil(h);
+	while (lua_next(h, -2))
+	{
+		lua_pop(h, 1);
+		lua_pushvalue(h, -1);
+		lua_rawget(h, -4);
+		bool isConfig = !lua_isnil(h, -1);
+		lua_pop(h, 1);
+
+		if (!isConfig)
+		{
+			lua_pushvalue(h, -1);
+			lua_pushnil(h);
+			lua_rawset(h, -4);
+		}
+	}
+
+	// restore the configuration values frames might have replaced
+
+	lua_pushnil(h);
+	while (lua_next(h, -3))
+	{
+		lua_pushvalue(h, -2);
+		lua_insert(h, -2);
+		lua_rawset(h, -4);
+	}
+
+	lua_pop(h, 2);
+
+	// descriptions exported from the previous model are gone with it
+
+	lua_pushnil(h);
+	lua_setfield(h, LUA_REGISTRYINDEX, DOXYREST_LOADED_DESCRIPTIONS_KEY);
+}
+
+bool
+Generator::applyLuaGcConfig()
+{
+	lua_State* h = m_stringTemplate.m_luaState;
+
+	sl::String mode = getConfigValue("LUA_GC_MODE");
+	sl::String pauseString = getConfigValue("LUA_GC_PAUSE");
+	sl::String stepMulString = getConfigValue("LUA_GC_STEP_MULTIPLIER");
+	m_stopGcDuringExport = getConfigBoolean("LUA_GC_STOP_DURING_EXPORT");
+
+	int pause = atoi(pauseString.sz()); // 0 means "keep the default"
+	int stepMul = atoi(stepMulString.sz());
+
+	if (mode == "generational")
+	{
+#if (LUA_VERSION_NUM >= 504)
+		lua_gc(h, LUA_GCGEN, 0, 0);
+		return true;
+#else
+		fprintf(stderr, "warning: generational GC requires Lua 5.4, using incremental GC\n");
+#endif
+	}
+	else if (!mode.isEmpty() && mode != "incremental")
+	{
+		err::setFormatStringError("invalid LUA_GC_MODE: '%s'", mode.sz());
+		return false;
+	}
+
+#if (LUA_VERSION_NUM >= 504)
+	lua_gc(h, LUA_GCINC, pause, stepMul, 0);
+#else
+	if (pause)
+		lua_gc(h, LUA_GCSETPAUSE, pause);
+
+	if (stepMul)
+		lua_gc(h, LUA_GCSETSTEPMUL, stepMul);
+#endif
+
 	return true;
 }
 
+void
+Generator::applyLuaCompatShims()
+{
+#if (LUA_VERSION_NUM < 502)
+	// Lua 5.1 and LuaJIT (unless built with LUAJIT_ENABLE_LUA52COMPAT) lack
+	// table.pack and table.unpack which are used by frames
+
+	lua_State* h = m_stringTemplate.m_luaState;
+
+	lua_getglobal(h, "table");
+
+	lua_getfield(h, -1, "pack");
+	bool hasPack = !lua_isnil(h, -1);
+	lua_pop(h, 1);
+
+	if (!hasPack)
+	{
+		lua_pushcfunction(h, tablePack_lua);
+		lua_setfield(h, -2, "pack");
+	}
+
+	lua_getfield(h, -1, "unpack");
+	bool hasUnpack = !lua_isnil(h, -1);
+	lua_pop(h, 1);
+
+	if (!hasUnpack)
+	{
+		lua_getglobal(h, "unpack");
+		lua_setfield(h, -2, "unpack");
+	}
+
+	lua_pop(h, 1);
+#endif
+}
+
+#if (LUA_VERSION_NUM < 502)
+int
+Generator::tablePack_lua(lua_State* h)
+{
+	int count = lua_gettop(h);
+	lua_createtable(h, count, 1);
+	lua_insert(h, 1);
+
+	for (int i = count; i >= 1; i--)
+		lua_rawseti(h, 1, i);
+
+	lua_pushinteger(h, count);
+	lua_setfield(h, 1, "n");
+	return 1;
+}
+#endif
+
+size_t
+Generator::getLuaHeapSize()
+{
+	lua_State* h = m_stringTemplate.m_luaState;
+	return (size_t)lua_gc(h, LUA_GCCOUNT, 0) * 1024 + lua_gc(h, LUA_GCCOUNTB, 0);
+}
+
 bool
 Generator::luaExport(
 	Module* module,
 	GlobalNamespace* globalNamespace
 	)
 {
+	if (m_module)
+		resetFrameGlobals(); // a model has been exported (and maybe rendered) before
+
+	m_module = module;
+
 	m_stringTemplate.m_luaState.registerFunction("includeFile", includeFile_lua, this);
 	m_stringTemplate.m_luaState.registerFunction("includeFileWithIndent", includeFileWithIndent_lua, this);
 	m_stringTemplate.m_luaState.registerFunction("generateFile", generateFile_lua, this);
+	m_stringTemplate.m_luaState.registerFunction("addCrefDbEntry", addCrefDbEntry_lua, this);
+	m_stringTemplate.m_luaState.registerFunction("writeCrefDb", writeCrefDb_lua, this);
+
+	// the exported tables stay alive until the very end anyway, so collecting
+	// garbage while exporting is mostly a waste of time
+
+	if (m_stopGcDuringExport)
+		lua_gc(m_stringTemplate.m_luaState, LUA_GCSTOP, 0);
 
 	m_stringTemplate.m_luaState.createTable();
 	m_stringTemplate.m_luaState.setGlobal("g_exportCache");
@@ -105,9 +391,82 @@ Generator::luaExport(
 	m_stringTemplate.m_luaState.pushNil(); // export cache is only needed during export-time
 	m_stringTemplate.m_luaState.setGlobal("g_exportCache");
 
+	recordLuaHeapSize("export");
+
+	if (m_isMemoryStatsEnabled)
+	{
+		static const char* globalNameTable[] =
+		{
+			"g_globalNamespace",
+			"g_groupArray",
+			"g_pageArray",
+			"g_exampleArray",
+		};
+
+		m_luaMemoryStats.collect(m_stringTemplate.m_luaState, globalNameTable, countof(globalNameTable));
+	}
+
+	if (m_stopGcDuringExport)
+		lua_gc(m_stringTemplate.m_luaState, LUA_GCRESTART, 0);
+
 	return true;
 }
 
+bool
+Generator::generate()
+{
+	m_searchIndex.clear();
+	m_outputSink->resetCounters();
+
+	// non-job output (the master file, the cref db, etc.) is written by the
+	// normal & merge runs only
+
+	m_jobIndex = 0;
+	m_renderedJobCount = 0;
+	m_isFileWritten = m_mode == GeneratorMode_Normal || m_mode == GeneratorMode_Merge;
+
+	bool result = generate(m_outputFileName, m_frameFileName);
+	recordLuaHeapSize("rendering");
+	if (!result)
+		return false;
+
+	// shards and the merge run don't see all the pages
+
+	if (!m_searchIndexDir.isEmpty() && m_mode == GeneratorMode_Normal)
+	{
+		result = writeSearchIndex();
+		if (!result)
+			return false;
+	}
+
+	switch (m_mode)
+	{
+	case GeneratorMode_Plan:
+		result = m_plan.write(m_planFileName);
+		if (!result)
+			return false;
+
+		break;
+
+	case GeneratorMode_Shard:
+	case GeneratorMode_Merge:
+		if (m_jobIndex != m_plan.getJobCount())
+		{
+			err::setFormatStringError(
+				"generation plan mismatch: %d files planned, %d requested by frames",
+				(int)m_plan.getJobCount(),
+				(int)m_jobIndex
+				);
+
+			return false;
+		}
+
+		break;
+	}
+
+	return m_outputSink->finalize();
+}
+
 bool
 Generator::generate(
 	const sl::StringRef& targetFileName,
@@ -124,18 +483,200 @@ Generator::generate(
 	}
 
 	sl::String targetDir = io::getDir(targetFileName);
-	result = io::ensureDirExists(targetDir);
-	if (!result)
-		return false;
+	if (m_outputSink->getKind() == OutputSinkKind_Dir)
+	{
+		result = io::ensureDirExists(targetDir);
+		if (!result)
+			return false;
+	}
 
-	m_frameDir = io::getDir(frameFilePath);
 	m_targetDir = io::getFullFilePath(targetDir);
 
+	if (m_outputSink->getKind() != OutputSinkKind_Dir) // archive/memory paths are relative to the master file
+		((RelativeOutputSink*)m_outputSink)->setRootDir(m_targetDir);
+
+	m_frameDir = io::getDir(frameFilePath);
+
 	m_stringTemplate.m_luaState.setGlobalString("g_frameDir", m_frameDir);
 	m_stringTemplate.m_luaState.setGlobalString("g_targetDir", m_targetDir);
 	m_stringTemplate.m_luaState.setGlobalString("g_targetFileName", targetFileName);
 
-	return m_stringTemplate.processFileToFile(targetFileName, frameFilePath);
+	sl::String targetFilePath = io::concatFilePath(m_targetDir, io::getFileName(targetFileName));
+	return processFileToSink(targetFilePath, frameFilePath);
+}
+
+bool
+Generator::processFileToSink(
+	const sl::StringRef& targetFilePath,
+	const sl::StringRef& frameFilePath
+	)
+{
+	sl::String contents;
+	bool result = m_stringTemplate.processFile(&contents, frameFilePath);
+	if (!result)
+		return false;
+
+	return isOutputSuppressed() || m_outputSink->writeFile(targetFilePath, contents);
+}
+
+bool
+Generator::processJob(
+	const sl::StringRef& targetFileName,
+	const sl::StringRef& frameFileName,
+	size_t baseArgCount,
+	bool* isSkipped,
+	bool* isWritten
+	)
+{
+	size_t jobIndex = m_jobIndex++;
+	sl::String argIdList = getArgIdList(baseArgCount);
+
+	if (m_mode == GeneratorMode_Plan)
+	{
+		// frames still run to discover the nested files
+
+		*isSkipped = false;
+		*isWritten = false;
+		return m_plan.addJob(m_targetFileDepth, targetFileName, frameFileName, argIdList);
+	}
+
+	// frames must request exactly the same files in the same order as they
+	// did during the planning run -- otherwise, shards won't add up
+
+	const GenerationJob* job = m_plan.getJob(jobIndex);
+	if (!job ||
+		job->m_depth != m_targetFileDepth ||
+		job->m_targetFileName != targetFileName ||
+		job->m_frameFileName != frameFileName ||
+		job->m_argIdList != argIdList)
+	{
+		err::setFormatStringError(
+			"generation plan mismatch at file #%d ('%s'): input, configuration or frames changed since planning",
+			(int)jobIndex + 1,
+			targetFileName.sz()
+			);
+
+		return false;
+	}
+
+	// a job with no files of this shard inside is skipped along with all the
+	// files it would have generated; the rest run, but only owned ones are written
+
+	*isSkipped = !job->m_isNeeded;
+	*isWritten = job->m_isOwned;
+
+	if (*isSkipped)
+		m_jobIndex = job->m_endIndex;
+	else if (*isWritten)
+		m_renderedJobCount++;
+
+	return true;
+}
+
+sl::String
+Generator::getArgIdList(size_t baseArgCount)
+{
+	lua_State* h = m_stringTemplate.m_luaState;
+	int top = lua_gettop(h);
+
+	sl::String argIdList;
+
+	for (int i = (int)baseArgCount + 1; i <= top; i++)
+	{
+		if (!argIdList.isEmpty())
+			argIdList += ' ';
+
+		const char* id = NULL;
+
+		if (lua_istable(h, i))
+		{
+			lua_getfield(h, i, "id");
+			id = lua_tostring(h, -1);
+			lua_pop(h, 1); // the string stays alive -- it's still referenced by the table
+		}
+
+		argIdList += id && *id ? id : "-";
+	}
+
+	return argIdList;
+}
+
+// the C++ side frees the doc block trees; the Lua side drops cached
+// docBlockList fields (the garbage collector takes care of the rest), so the
+// next access re-parses the description from XML
+
+void
+Generator::unloadDescriptions()
+{
+	lua_State* h = m_stringTemplate.m_luaState;
+
+	size_t heapSize = getLuaHeapSize();
+	if (heapSize > m_peakLuaHeapSize)
+		m_peakLuaHeapSize = heapSize;
+
+	lua_getfield(h, LUA_REGISTRYINDEX, DOXYREST_LOADED_DESCRIPTIONS_KEY);
+	if (lua_istable(h, -1))
+	{
+		lua_pushnil(h);
+		while (lua_next(h, -2))
+		{
+			lua_pop(h, 1); // the key (description table) stays for lua_next
+			lua_pushnil(h);
+			lua_setfield(h, -2, "docBlockList");
+		}
+
+		lua_newtable(h);
+		lua_setfield(h, LUA_REGISTRYINDEX, DOXYREST_LOADED_DESCRIPTIONS_KEY);
+	}
+
+	lua_pop(h, 1);
+
+	m_module->unloadDescriptions();
+}
+
+// items passed to generateFile (e.g. a class for its own page) are rendered on
+// that page; everything else is located via its container
+
+void
+Generator::addSearchIndexPages(
+	const sl::StringRef& targetFileName,
+	size_t baseArgCount
+	)
+{
+	sl::String argIdList = getArgIdList(baseArgCount);
+
+	const char* p = argIdList.sz();
+	while (*p)
+	{
+		const char* end = strchr(p, ' ');
+		if (!end)
+			end = p + strlen(p);
+
+		sl::StringRef id(p, end - p);
+		if (id != "-")
+			m_searchIndex.addPage(id, targetFileName);
+
+		p = *end ? end + 1 : end;
+	}
+}
+
+bool
+Generator::writeSearchIndex()
+{
+	if (!m_module)
+		return true;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	m_searchIndex.build(m_module);
+
+	if (m_module->m_isStreaming) // briefs were parsed for the index
+		unloadDescriptions();
+
+	bool result = m_searchIndex.write(m_outputSink, io::concatFilePath(m_targetDir, m_searchIndexDir));
+
+	m_searchIndexBuildTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	return result;
 }
 
 bool
@@ -147,6 +688,18 @@ Generator::processFile(
 	)
 {
 	bool result;
+	bool isWritten = true;
+
+	if (!targetFileName.isEmpty() && m_mode != GeneratorMode_Normal)
+	{
+		bool isSkipped;
+		result = processJob(targetFileName, frameFileName, baseArgCount, &isSkipped, &isWritten);
+		if (!result)
+			return false;
+
+		if (isSkipped)
+			return true;
+	}
 
 	sl::String frameFilePath = io::findFilePath(frameFileName, m_frameDir, &m_frameDirList);
 	if (frameFilePath.isEmpty())
@@ -170,10 +723,28 @@ Generator::processFile(
 		m_stringTemplate.m_luaState.setGlobalString("g_targetFileName", targetFileName);
 
 		sl::String targetFilePath = io::concatFilePath(m_targetDir, targetFileName);
-		result = m_stringTemplate.processFileToFile(targetFilePath, frameFilePath);
+
+		if (!m_searchIndexDir.isEmpty())
+			addSearchIndexPages(targetFileName, baseArgCount);
+
+		bool prevIsFileWritten = m_isFileWritten;
+		m_isFileWritten = isWritten;
+		m_targetFileDepth++;
+		result = processFileToSink(targetFilePath, frameFilePath);
+		m_targetFileDepth--;
+		m_isFileWritten = prevIsFileWritten;
+
 		if (!result)
 			return false;
 
+		// unload after every file, nested ones included: with the standard
+		// frames, all namespace & class pages are nested in global.rst.
+		// frames only keep exported Lua copies, so a description the parent
+		// frame still needs is simply re-parsed on its next access
+
+		if (m_module && m_module->m_isStreaming)
+			unloadDescriptions();
+
 		m_stringTemplate.m_luaState.setGlobalString("g_targetFileName", prevTargetFileName);
 	}
 	else if (!indent.isEmpty())
@@ -276,4 +847,41 @@ Generator::generateFile_lua(lua_State* h)
 	return 0;
 }
 
+int
+Generator::addCrefDbEntry_lua(lua_State* h)
+{
+	lua::LuaNonOwnerState luaState(h);
+	Generator* self = (Generator*)luaState.getContext();
+	ASSERT(self->m_stringTemplate.m_luaState == h);
+
+	sl::StringRef name = luaState.getString(1);
+	sl::StringRef target = luaState.getString(2);
+
+	self->m_crefDb.add(name, target);
+	return 0;
+}
+
+int
+Generator::writeCrefDb_lua(lua_State* h)
+{
+	lua::LuaNonOwnerState luaState(h);
+	Generator* self = (Generator*)luaState.getContext();
+	ASSERT(self->m_stringTemplate.m_luaState == h);
+
+	sl::StringRef fileName = luaState.getString(1);
+	sl::String filePath = io::concatFilePath(self->m_targetDir, fileName);
+
+	bool result = self->isOutputSuppressed() || self->m_crefDb.write(self->m_outputSink, filePath);
+	if (!result)
+	{
+		luaState.prepareLastErrorString();
+		luaState.error();
+		ASSERT(false);
+		return -1;
+	}
+
+	self->m_crefDb.clear();
+	return 0;
+}
+
 //..............................................................................
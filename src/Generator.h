@@ -12,12 +12,35 @@
 #pragma once
 
 #include "CmdLine.h"
+#include "CrefDb.h"
+#include "OutputSink.h"
+#include "GenerationPlan.h"
+#include "SearchIndex.h"
+#include "MemoryStats.h"
 
 struct Module;
 class GlobalNamespace;
 
 //..............................................................................
 
+struct LuaHeapSample
+{
+	const char* m_phase;
+	size_t m_size;
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+enum GeneratorMode
+{
+	GeneratorMode_Normal,
+	GeneratorMode_Plan,  // record all generateFile calls, write nothing
+	GeneratorMode_Shard, // write a share of the planned files
+	GeneratorMode_Merge, // write everything except the planned files
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
 class Generator
 {
 protected:
@@ -28,10 +51,152 @@ protected:
 	sl::BoxList<sl::String> m_frameDirList;
 	sl::String m_frameFileName;
 	sl::String m_outputFileName;
+	CrefDb m_crefDb;
+	DirOutputSink m_dirOutputSink;
+	TarOutputSink m_tarOutputSink;
+	OutputSink* m_outputSink;
+	bool m_stopGcDuringExport;
+	sl::Array<LuaHeapSample> m_luaHeapSampleArray;
+
+	GeneratorMode m_mode;
+	GenerationPlan m_plan;
+	sl::String m_planFileName;
+	size_t m_shardIndex;
+	size_t m_shardCount;
+	size_t m_jobIndex;
+	size_t m_renderedJobCount;
+	size_t m_targetFileDepth; // > 0 while rendering a file requested with generateFile
+	bool m_isFileWritten; // the file being rendered goes to the output sink
+
+	Module* m_module; // set on luaExport
+	size_t m_peakLuaHeapSize; // measured between top-level files in streaming mode
+
+	bool m_isMemoryStatsEnabled; // --stats
+	LuaMemoryStats m_luaMemoryStats; // after export
+
+	sl::String m_searchIndexDir; // relative to the master output file; empty if disabled
+	SearchIndex m_searchIndex;
+	double m_searchIndexBuildTime; // ms
 
 public:
+	Generator()
+	{
+		m_stopGcDuringExport = false;
+		m_outputSink = &m_dirOutputSink;
+		m_mode = GeneratorMode_Normal;
+		m_shardIndex = 0;
+		m_shardCount = 1;
+		m_jobIndex = 0;
+		m_renderedJobCount = 0;
+		m_targetFileDepth = 0;
+		m_isFileWritten = true;
+		m_module = NULL;
+		m_peakLuaHeapSize = 0;
+		m_searchIndexBuildTime = 0;
+		m_isMemoryStatsEnabled = false;
+	}
+
 	bool
-	create(const CmdLine* cmdLine);
+	create(const CmdLine* cmdLine)
+	{
+		return create(cmdLine, cmdLine->m_configFileName);
+	}
+
+	bool
+	create(
+		const CmdLine* cmdLine,
+		const sl::StringRef& configFileName
+		);
+
+	const sl::String&
+	getOutputFileName()
+	{
+		return m_outputFileName;
+	}
+
+	OutputSink*
+	getOutputSink()
+	{
+		return m_outputSink;
+	}
+
+	DirOutputSink*
+	getDirOutputSink()
+	{
+		return &m_dirOutputSink;
+	}
+
+	const sl::BoxList<sl::String>&
+	getFrameDirList()
+	{
+		return m_frameDirList;
+	}
+
+	GeneratorMode
+	getMode()
+	{
+		return m_mode;
+	}
+
+	size_t
+	getPlannedJobCount()
+	{
+		return m_plan.getJobCount();
+	}
+
+	size_t
+	getRenderedJobCount()
+	{
+		return m_renderedJobCount;
+	}
+
+	// redirect all the generated files to a custom sink (e.g. MemoryOutputSink);
+	// relative sinks get their root directory set on generate()
+
+	void
+	setOutputSink(OutputSink* sink)
+	{
+		m_outputSink = sink ? sink : &m_dirOutputSink;
+	}
+
+	const sl::Array<LuaHeapSample>&
+	getLuaHeapSampleArray()
+	{
+		return m_luaHeapSampleArray;
+	}
+
+	size_t
+	getLuaHeapSize();
+
+	size_t
+	getPeakLuaHeapSize()
+	{
+		return m_peakLuaHeapSize;
+	}
+
+	LuaMemoryStats*
+	getLuaMemoryStats()
+	{
+		return &m_luaMemoryStats;
+	}
+
+	const sl::String&
+	getSearchIndexDir()
+	{
+		return m_searchIndexDir;
+	}
+
+	SearchIndex*
+	getSearchIndex()
+	{
+		return &m_searchIndex;
+	}
+
+	double
+	getSearchIndexBuildTime()
+	{
+		return m_searchIndexBuildTime;
+	}
 
 	sl::String
 	getConfigValue(const sl::StringRef& name)
@@ -39,6 +204,20 @@ public:
 		return m_stringTemplate.m_luaState.getGlobalString(name);
 	}
 
+	bool
+	getConfigBoolean(const sl::StringRef& name)
+	{
+		return m_stringTemplate.m_luaState.getGlobalBoolean(name);
+	}
+
+	// also updates the configuration snapshot (see resetFrameGlobals)
+
+	void
+	setConfigValue(
+		const sl::StringRef& name,
+		const sl::StringRef& value
+		);
+
 	bool
 	luaExport(
 		Module* module,
@@ -46,10 +225,7 @@ public:
 		);
 
 	bool
-	generate()
-	{
-		return generate(m_outputFileName, m_frameFileName);
-	}
+	generate();
 
 	bool
 	generate(
@@ -58,6 +234,36 @@ public:
 		);
 
 protected:
+	void
+	applyLuaCompatShims();
+
+	// frames keep their state in Lua globals (g_itemFileNameMap, include
+	// guards, etc); the globals as they are after configuration are saved, and
+	// everything frames added or replaced is dropped before exporting a new
+	// model -- so a reused Lua state renders like a fresh one
+
+	void
+	saveConfigGlobals();
+
+	void
+	resetFrameGlobals();
+
+	bool
+	applyLuaGcConfig();
+
+	void
+	recordLuaHeapSize(const char* phase)
+	{
+		LuaHeapSample sample = { phase, getLuaHeapSize() };
+		m_luaHeapSampleArray.append(sample);
+	}
+
+#if (LUA_VERSION_NUM < 502)
+	static
+	int
+	tablePack_lua(lua_State* h);
+#endif
+
 	static
 	int
 	includeFile_lua(lua_State* h);
@@ -70,6 +276,50 @@ protected:
 	int
 	generateFile_lua(lua_State* h);
 
+	static
+	int
+	addCrefDbEntry_lua(lua_State* h);
+
+	static
+	int
+	writeCrefDb_lua(lua_State* h);
+
+	bool
+	isOutputSuppressed()
+	{
+		return !m_isFileWritten;
+	}
+
+	bool
+	processJob(
+		const sl::StringRef& targetFileName,
+		const sl::StringRef& frameFileName,
+		size_t baseArgCount,
+		bool* isSkipped,
+		bool* isWritten
+		);
+
+	sl::String
+	getArgIdList(size_t baseArgCount);
+
+	void
+	unloadDescriptions();
+
+	void
+	addSearchIndexPages(
+		const sl::StringRef& targetFileName,
+		size_t baseArgCount
+		);
+
+	bool
+	writeSearchIndex();
+
+	bool
+	processFileToSink(
+		const sl::StringRef& targetFilePath,
+		const sl::StringRef& frameFilePath
+		);
+
 	bool
 	processFile(
 		const sl::StringRef& indent,
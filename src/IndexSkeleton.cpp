@@ -0,0 +1,287 @@
+//..............................................................................
+//
+//  This file is part of the Doxyrest toolkit.
+//
+//  Doxyrest is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/doxyrest/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "IndexSkeleton.h"
+#include "DoxyXmlParser.h"
+
+//..............................................................................
+
+sl::String
+IndexMember::getQualifiedName() const
+{
+	return m_compound && m_compound->isScope() ?
+		m_compound->m_name + "::" + m_name :
+		m_name;
+}
+
+//..............................................................................
+
+void
+IndexSkeleton::clear()
+{
+	m_compoundList.clear();
+	m_memberList.clear();
+	m_compoundMap.clear();
+	m_memberMap.clear();
+	m_memberListingCount = 0;
+}
+
+bool
+IndexSkeleton::load(const sl::StringRef& fileName)
+{
+	clear();
+
+	IndexSkeletonParser parser(this);
+	bool result = parser.parseFile(fileName, DoxyXmlParser_DefaultBlockSize);
+	if (!result)
+		return false;
+
+	resolveParents();
+	return true;
+}
+
+bool
+IndexSkeleton::load(
+	DoxyXmlArchive* archive,
+	const sl::StringRef& path
+	)
+{
+	clear();
+
+	DoxyXmlArchiveFile file;
+	bool result = archive->openFile(path, &file);
+	if (!result)
+		return false;
+
+	IndexSkeletonParser parser(this);
+	result =
+		parser.create() &&
+		parser.parse(file.m_p, file.m_size, true);
+
+	if (!result)
+		return false;
+
+	resolveParents();
+	return true;
+}
+
+bool
+IndexSkeleton::loadInput(const sl::StringRef& inputFileName)
+{
+	if (getDoxyXmlArchiveKind(inputFileName) == DoxyXmlArchiveKind_Undefined)
+		return load(inputFileName);
+
+	DoxyXmlArchive archive;
+	bool result = archive.open(inputFileName);
+	if (!result)
+		return false;
+
+	sl::String indexPath = archive.findIndexFile();
+	if (indexPath.isEmpty())
+	{
+		err::setFormatStringError("no index.xml in '%s'", inputFileName.sz());
+		return false;
+	}
+
+	return load(&archive, indexPath);
+}
+
+IndexCompound*
+IndexSkeleton::addCompound(
+	const sl::StringRef& id,
+	CompoundKind compoundKind
+	)
+{
+	IndexCompound* compound = AXL_MEM_NEW(IndexCompound);
+	compound->m_id = id;
+	compound->m_compoundKind = compoundKind;
+	m_compoundList.insertTail(compound);
+	m_compoundMap.visit(id)->m_value = compound;
+	return compound;
+}
+
+IndexMember*
+IndexSkeleton::addMember(
+	IndexCompound* compound,
+	const sl::StringRef& id,
+	MemberKind memberKind
+	)
+{
+	m_memberListingCount++;
+	compound->m_memberCount++;
+
+	// members are listed by every compound they belong to (class or namespace,
+	// file, groups); prefer the scope over files and groups
+
+	sl::StringHashTableIterator<IndexMember*> it = m_memberMap.visit(id);
+	if (it->m_value)
+	{
+		IndexMember* member = it->m_value;
+		if (!member->m_compound->isScope() && compound->isScope())
+			member->m_compound = compound;
+
+		return NULL; // already known
+	}
+
+	IndexMember* member = AXL_MEM_NEW(IndexMember);
+	member->m_id = id;
+	member->m_memberKind = memberKind;
+	member->m_compound = compound;
+	m_memberList.insertTail(member);
+	it->m_value = member;
+	return member;
+}
+
+void
+IndexSkeleton::resolveParents()
+{
+	sl::StringHashTable<IndexCompound*> scopeMap;
+
+	sl::Iterator<IndexCompound> it = m_compoundList.getHead();
+	for (; it; it++)
+		if (it->isScope())
+			scopeMap.visit(it->m_name)->m_value = *it;
+
+	it = m_compoundList.getHead();
+	for (; it; it++)
+	{
+		if (!it->isScope())
+			continue;
+
+		size_t i = it->m_name.reverseFind(':');
+		if (i != -1 && i > 0 && it->m_name.cp()[i - 1] == ':')
+			it->m_parent = scopeMap.findValue(it->m_name.getSubString(0, i - 1), NULL);
+	}
+}
+
+//..............................................................................
+
+void
+IndexSkeletonParser::onStartElement(
+	const char* name,
+	const char** attributes
+	)
+{
+	const char* refId = NULL;
+	const char* kind = NULL;
+
+	switch (m_state)
+	{
+	case State_Idle:
+		if (strcmp(name, "compound") != 0)
+			break;
+
+		for (; *attributes; attributes += 2)
+			if (strcmp(attributes[0], "refid") == 0)
+				refId = attributes[1];
+			else if (strcmp(attributes[0], "kind") == 0)
+				kind = attributes[1];
+
+		if (!refId)
+			break; // DoxygenIndexType will complain later
+
+		m_compound = m_skeleton->addCompound(
+			refId,
+			kind ? CompoundKindMap::findValue(kind, CompoundKind_Undefined) : CompoundKind_Undefined
+			);
+
+		m_state = State_Compound;
+		break;
+
+	case State_Compound:
+		if (strcmp(name, "name") == 0)
+		{
+			m_name.clear();
+			m_state = State_CompoundName;
+			break;
+		}
+
+		if (strcmp(name, "member") != 0)
+			break;
+
+		for (; *attributes; attributes += 2)
+			if (strcmp(attributes[0], "refid") == 0)
+				refId = attributes[1];
+			else if (strcmp(attributes[0], "kind") == 0)
+				kind = attributes[1];
+
+		if (!refId)
+			break;
+
+		m_member = m_skeleton->addMember(
+			m_compound,
+			refId,
+			kind ? MemberKindMap::findValue(kind, MemberKind_Undefined) : MemberKind_Undefined
+			);
+
+		m_state = State_Member;
+		break;
+
+	case State_Member:
+		if (strcmp(name, "name") == 0)
+		{
+			m_name.clear();
+			m_state = State_MemberName;
+		}
+
+		break;
+	}
+}
+
+void
+IndexSkeletonParser::onEndElement(const char* name)
+{
+	switch (m_state)
+	{
+	case State_Compound:
+		if (strcmp(name, "compound") == 0)
+		{
+			m_compound = NULL;
+			m_state = State_Idle;
+		}
+
+		break;
+
+	case State_CompoundName:
+		m_compound->m_name = m_name;
+		m_state = State_Compound;
+		break;
+
+	case State_Member:
+		if (strcmp(name, "member") == 0)
+		{
+			m_member = NULL;
+			m_state = State_Compound;
+		}
+
+		break;
+
+	case State_MemberName:
+		if (m_member) // NULL for duplicates
+			m_member->m_name = m_name;
+
+		m_state = State_Member;
+		break;
+	}
+}
+
+void
+IndexSkeletonParser::onCharacterData(
+	const char* string,
+	size_t length
+	)
+{
+	if (m_state == State_CompoundName || m_state == State_MemberName)
+		m_name.append(string, length);
+}
+
+//..............................................................................
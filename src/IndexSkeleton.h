@@ -0,0 +1,213 @@
+//..............................................................................
+//
+//  This file is part of the Doxyrest toolkit.
+//
+//  Doxyrest is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/doxyrest/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+#include "DoxyXmlEnum.h"
+#include "DoxyXmlArchive.h"
+
+struct IndexCompound;
+
+//..............................................................................
+
+// the symbol table of a Doxygen project as listed in index.xml -- ids, names,
+// kinds and parents of all compounds and members -- built in a single pass
+// without opening any of the compound files
+
+struct IndexMember: sl::ListLink
+{
+	sl::String m_id;
+	sl::String m_name;
+	MemberKind m_memberKind;
+	IndexCompound* m_compound; // the most specific of the listing compounds
+
+	IndexMember()
+	{
+		m_memberKind = MemberKind_Undefined;
+		m_compound = NULL;
+	}
+
+	sl::String
+	getQualifiedName() const;
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+struct IndexCompound: sl::ListLink
+{
+	sl::String m_id;
+	sl::String m_name; // already qualified
+	CompoundKind m_compoundKind;
+	IndexCompound* m_parent; // enclosing namespace or class (by qualified name)
+	size_t m_memberCount; // including members also listed by other compounds
+
+	IndexCompound()
+	{
+		m_compoundKind = CompoundKind_Undefined;
+		m_parent = NULL;
+		m_memberCount = 0;
+	}
+
+	bool
+	isScope() const
+	{
+		return
+			m_compoundKind != CompoundKind_File &&
+			m_compoundKind != CompoundKind_Dir &&
+			m_compoundKind != CompoundKind_Group &&
+			m_compoundKind != CompoundKind_Page &&
+			m_compoundKind != CompoundKind_Example;
+	}
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+class IndexSkeleton
+{
+	friend class IndexSkeletonParser;
+
+protected:
+	sl::List<IndexCompound> m_compoundList;
+	sl::List<IndexMember> m_memberList; // unique members only
+	sl::StringHashTable<IndexCompound*> m_compoundMap;
+	sl::StringHashTable<IndexMember*> m_memberMap;
+	size_t m_memberListingCount; // members as listed (with duplicates)
+
+public:
+	IndexSkeleton()
+	{
+		m_memberListingCount = 0;
+	}
+
+	const sl::List<IndexCompound>&
+	getCompoundList()
+	{
+		return m_compoundList;
+	}
+
+	const sl::List<IndexMember>&
+	getMemberList()
+	{
+		return m_memberList;
+	}
+
+	size_t
+	getMemberListingCount()
+	{
+		return m_memberListingCount;
+	}
+
+	// the number of distinct ids -- i.e., the minimal size of the id tables
+	// of the full model
+
+	size_t
+	getIdCount()
+	{
+		return m_compoundList.getCount() + m_memberList.getCount();
+	}
+
+	IndexCompound*
+	findCompound(const sl::StringRef& id)
+	{
+		return m_compoundMap.findValue(id, NULL);
+	}
+
+	IndexMember*
+	findMember(const sl::StringRef& id)
+	{
+		return m_memberMap.findValue(id, NULL);
+	}
+
+	void
+	clear();
+
+	bool
+	load(const sl::StringRef& fileName);
+
+	bool
+	load(
+		DoxyXmlArchive* archive,
+		const sl::StringRef& path // path inside the archive
+		);
+
+	// index.xml or an archive containing it
+
+	bool
+	loadInput(const sl::StringRef& inputFileName);
+
+protected:
+	IndexCompound*
+	addCompound(
+		const sl::StringRef& id,
+		CompoundKind compoundKind
+		);
+
+	IndexMember*
+	addMember(
+		IndexCompound* compound,
+		const sl::StringRef& id,
+		MemberKind memberKind
+		);
+
+	void
+	resolveParents();
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+class IndexSkeletonParser: public xml::ExpatParser<IndexSkeletonParser>
+{
+	friend class xml::ExpatParser<IndexSkeletonParser>;
+
+protected:
+	enum State
+	{
+		State_Idle,
+		State_Compound,
+		State_CompoundName,
+		State_Member,
+		State_MemberName,
+	};
+
+protected:
+	IndexSkeleton* m_skeleton;
+	State m_state;
+	IndexCompound* m_compound;
+	IndexMember* m_member;
+	sl::String m_name;
+
+public:
+	IndexSkeletonParser(IndexSkeleton* skeleton)
+	{
+		m_skeleton = skeleton;
+		m_state = State_Idle;
+		m_compound = NULL;
+		m_member = NULL;
+	}
+
+protected:
+	void
+	onStartElement(
+		const char* name,
+		const char** attributes
+		);
+
+	void
+	onEndElement(const char* name);
+
+	void
+	onCharacterData(
+		const char* string,
+		size_t length
+		);
+};
+
+//..............................................................................
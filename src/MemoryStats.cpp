@@ -0,0 +1,587 @@
+//..............................................................................
+//
+//  This file is part of the Doxyrest toolkit.
+//
+//  Doxyrest is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/doxyrest/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "MemoryStats.h"
+#include "Module.h"
+
+//..............................................................................
+
+const char*
+getModelObjectKindString(ModelObjectKind kind)
+{
+	const char* stringTable[] =
+	{
+		"Compound",              // ModelObjectKind_Compound
+		"Member",                // ModelObjectKind_Member
+		"Param",                 // ModelObjectKind_Param
+		"EnumValue",             // ModelObjectKind_EnumValue
+		"Ref",                   // ModelObjectKind_Ref
+		"RefText",               // ModelObjectKind_RefText
+		"DocBlock",              // ModelObjectKind_DocBlock
+		"DocRefBlock",           // ModelObjectKind_DocRefBlock
+		"DocAnchorBlock",        // ModelObjectKind_DocAnchorBlock
+		"DocImageBlock",         // ModelObjectKind_DocImageBlock
+		"DocUlinkBlock",         // ModelObjectKind_DocUlinkBlock
+		"DocHeadingBlock",       // ModelObjectKind_DocHeadingBlock
+		"DocSectionBlock",       // ModelObjectKind_DocSectionBlock
+		"DocSimpleSectionBlock", // ModelObjectKind_DocSimpleSectionBlock
+		"DescriptionSource",     // ModelObjectKind_DescriptionSource
+		"PathNode",              // ModelObjectKind_PathNode
+		"Namespace",             // ModelObjectKind_Namespace
+		"arrays & lists",        // ModelObjectKind_Array
+		"string payloads",       // ModelObjectKind_String
+		"hash tables",           // ModelObjectKind_HashTable
+	};
+
+	return (size_t)kind < countof(stringTable) ?
+		stringTable[kind] :
+		"<undefined>";
+}
+
+const char*
+getLuaObjectKindString(LuaObjectKind kind)
+{
+	const char* stringTable[] =
+	{
+		"compound",    // LuaObjectKind_Compound
+		"member",      // LuaObjectKind_Member
+		"enumValue",   // LuaObjectKind_EnumValue
+		"param",       // LuaObjectKind_Param
+		"docBlock",    // LuaObjectKind_DocBlock
+		"refText",     // LuaObjectKind_RefText
+		"linkedText",  // LuaObjectKind_LinkedText
+		"description", // LuaObjectKind_Description
+		"location",    // LuaObjectKind_Location
+		"other",       // LuaObjectKind_Other
+	};
+
+	return (size_t)kind < countof(stringTable) ?
+		stringTable[kind] :
+		"<undefined>";
+}
+
+// sl::StringHashTable entry: key, value, list links and the bucket link (plus
+// the bucket head)
+
+inline
+size_t
+getStringHashTableEntrySize(size_t valueSize)
+{
+	return sizeof(sl::String) + valueSize + 4 * sizeof(void*);
+}
+
+//..............................................................................
+
+size_t
+ModelMemoryStats::getTotalSize()
+{
+	size_t size = 0;
+	for (size_t i = 0; i < ModelObjectKind_Count; i++)
+		size += m_entryTable[i].m_size;
+
+	return size;
+}
+
+void
+ModelMemoryStats::clear()
+{
+	memset(m_entryTable, 0, sizeof(m_entryTable));
+	m_stringBufferSet.clear();
+}
+
+void
+ModelMemoryStats::collect(
+	Module* module,
+	GlobalNamespace* globalNamespace
+	)
+{
+	clear();
+
+	sl::Iterator<Compound> compoundIt = module->m_compoundList.getHead();
+	for (; compoundIt; compoundIt++)
+		addCompound(*compoundIt);
+
+	sl::Iterator<DescriptionSource> sourceIt = module->m_descriptionSourceList.getHead();
+	for (; sourceIt; sourceIt++)
+	{
+		add(ModelObjectKind_DescriptionSource, sizeof(DescriptionSource));
+		addString(sourceIt->m_filePath);
+	}
+
+	size_t pathNodeCount = module->m_pathTable.getCount();
+	if (pathNodeCount)
+		add(ModelObjectKind_PathNode, pathNodeCount * sizeof(PathNode), pathNodeCount);
+
+	addArray(module->m_namespaceArray);
+	addArray(module->m_groupArray);
+	addArray(module->m_pageArray);
+	addArray(module->m_exampleArray);
+	addArray(module->m_handleTable);
+	addArray(module->m_loadedDescriptionArray);
+
+	// keys of the intern table share buffers with the interned strings, so
+	// most of them are already counted by now
+
+	sl::StringHashTableIterator<bool> internIt = module->m_internTable.getHead();
+	for (; internIt; internIt++)
+		addString(internIt->getKey());
+
+	sl::StringHashTableIterator<size_t> handleIt = module->m_handleMap.getHead();
+	for (; handleIt; handleIt++)
+		addString(handleIt->getKey());
+
+	size_t internCount = module->m_internTable.getCount();
+	size_t handleCount = module->m_handleMap.getCount();
+
+	add(
+		ModelObjectKind_HashTable,
+		internCount * getStringHashTableEntrySize(sizeof(bool)) +
+		handleCount * getStringHashTableEntrySize(sizeof(size_t)),
+		2
+		);
+
+	if (!globalNamespace)
+		return;
+
+	addNamespaceContents(*globalNamespace);
+
+	sl::ConstIterator<Namespace> namespaceIt = globalNamespace->getNamespaceList().getHead();
+	for (; namespaceIt; namespaceIt++)
+	{
+		add(ModelObjectKind_Namespace, sizeof(Namespace));
+		addNamespaceContents(**namespaceIt);
+	}
+}
+
+// strings share buffers (interning, substrings), so each buffer is counted
+// once -- by its first user
+
+void
+ModelMemoryStats::addString(const sl::String& string)
+{
+	if (string.isEmpty())
+		return;
+
+	if (!m_stringBufferSet.insert(string.cp()).second)
+		return;
+
+	add(ModelObjectKind_String, string.getLength() + 1);
+}
+
+void
+ModelMemoryStats::addStringList(const sl::BoxList<sl::String>& list)
+{
+	sl::ConstBoxIterator<sl::String> it = list.getHead();
+	for (; it; it++)
+	{
+		add(ModelObjectKind_Array, sizeof(sl::String) + 2 * sizeof(void*));
+		addString(*it);
+	}
+}
+
+void
+ModelMemoryStats::addCompound(Compound* compound)
+{
+	add(ModelObjectKind_Compound, sizeof(Compound));
+
+	addString(compound->m_id);
+	addString(compound->m_importId);
+	addString(compound->m_name);
+	addString(compound->m_title);
+	addStringList(compound->m_importList);
+	addParamList(compound->m_templateParamList);
+	addParamList(compound->m_templateSpecParamList);
+	addRefList(compound->m_baseRefList);
+	addRefList(compound->m_derivedRefList);
+	addRefList(compound->m_innerRefList);
+
+	addArray(compound->m_groupFootnoteArray);
+	addArray(compound->m_baseTypeArray);
+	addArray(compound->m_baseTypeClosureArray);
+	addArray(compound->m_derivedTypeArray_doxy);
+	addArray(compound->m_derivedTypeArray_auto);
+	addArray(compound->m_baseTypeProtectionArray);
+	addArray(compound->m_subPageArray);
+	addArray(compound->m_usedByArray);
+
+	addDescription(compound->m_briefDescription);
+	addDescription(compound->m_detailedDescription);
+	addLocation(compound->m_location);
+
+	sl::Iterator<Member> it = compound->m_memberList.getHead();
+	for (; it; it++)
+		addMember(*it);
+}
+
+void
+ModelMemoryStats::addMember(Member* member)
+{
+	add(ModelObjectKind_Member, sizeof(Member));
+
+	addString(member->m_id);
+	addString(member->m_name);
+	addString(member->m_definition);
+	addString(member->m_argString);
+	addString(member->m_bitField);
+	addString(member->m_modifiers);
+	addLinkedText(member->m_type);
+	addLinkedText(member->m_initializer);
+	addLinkedText(member->m_exceptions);
+	addStringList(member->m_importList);
+	addParamList(member->m_paramList);
+	addParamList(member->m_templateParamList);
+	addParamList(member->m_templateSpecParamList);
+	addArray(member->m_usedByArray);
+
+	sl::Iterator<EnumValue> it = member->m_enumValueList.getHead();
+	for (; it; it++)
+		addEnumValue(*it);
+
+	addDescription(member->m_briefDescription);
+	addDescription(member->m_detailedDescription);
+	addDescription(member->m_inBodyDescription);
+	addLocation(member->m_location);
+}
+
+void
+ModelMemoryStats::addParamList(const sl::List<Param>& list)
+{
+	sl::ConstIterator<Param> it = list.getHead();
+	for (; it; it++)
+	{
+		add(ModelObjectKind_Param, sizeof(Param));
+
+		addLinkedText(it->m_type);
+		addString(it->m_declarationName);
+		addString(it->m_definitionName);
+		addString(it->m_array);
+		addLinkedText(it->m_defaultValue);
+		addLinkedText(it->m_typeConstraint);
+		addDescription(it->m_briefDescription);
+	}
+}
+
+void
+ModelMemoryStats::addEnumValue(EnumValue* enumValue)
+{
+	add(ModelObjectKind_EnumValue, sizeof(EnumValue));
+
+	addString(enumValue->m_id);
+	addString(enumValue->m_name);
+	addLinkedText(enumValue->m_initializer);
+	addDescription(enumValue->m_briefDescription);
+	addDescription(enumValue->m_detailedDescription);
+}
+
+void
+ModelMemoryStats::addRefList(const sl::List<Ref>& list)
+{
+	sl::ConstIterator<Ref> it = list.getHead();
+	for (; it; it++)
+	{
+		add(ModelObjectKind_Ref, sizeof(Ref));
+
+		addString(it->m_id);
+		addString(it->m_importId);
+		addString(it->m_text);
+	}
+}
+
+void
+ModelMemoryStats::addLinkedText(const LinkedText& text)
+{
+	addString(text.m_plainText);
+
+	sl::ConstIterator<RefText> it = text.m_refTextList.getHead();
+	for (; it; it++)
+	{
+		add(ModelObjectKind_RefText, sizeof(RefText));
+
+		addString(it->m_text);
+		addString(it->m_id);
+		addString(it->m_external);
+		addString(it->m_tooltip);
+	}
+}
+
+void
+ModelMemoryStats::addDescription(const Description& description)
+{
+	addString(description.m_title);
+	addArray(description.m_refHandleArray);
+	addDocBlockList(description.m_docBlockList);
+}
+
+void
+ModelMemoryStats::addDocBlockList(const sl::List<DocBlock>& list)
+{
+	sl::ConstIterator<DocBlock> it = list.getHead();
+	for (; it; it++)
+	{
+		DocBlock* block = (DocBlock*)*it;
+
+		switch (block->getDocBlockClass())
+		{
+		case DocBlockClass_Ref:
+			add(ModelObjectKind_DocRefBlock, sizeof(DocRefBlock));
+			addString(((DocRefBlock*)block)->m_id);
+			addString(((DocRefBlock*)block)->m_external);
+			break;
+
+		case DocBlockClass_Anchor:
+			add(ModelObjectKind_DocAnchorBlock, sizeof(DocAnchorBlock));
+			addString(((DocAnchorBlock*)block)->m_id);
+			break;
+
+		case DocBlockClass_Image:
+			add(ModelObjectKind_DocImageBlock, sizeof(DocImageBlock));
+			addString(((DocImageBlock*)block)->m_name);
+			break;
+
+		case DocBlockClass_Ulink:
+			add(ModelObjectKind_DocUlinkBlock, sizeof(DocUlinkBlock));
+			addString(((DocUlinkBlock*)block)->m_url);
+			break;
+
+		case DocBlockClass_Heading:
+			add(ModelObjectKind_DocHeadingBlock, sizeof(DocHeadingBlock));
+			break;
+
+		case DocBlockClass_Section:
+			add(ModelObjectKind_DocSectionBlock, sizeof(DocSectionBlock));
+			addString(((DocSectionBlock*)block)->m_id);
+			break;
+
+		case DocBlockClass_SimpleSection:
+			add(ModelObjectKind_DocSimpleSectionBlock, sizeof(DocSimpleSectionBlock));
+			addString(((DocSimpleSectionBlock*)block)->m_simpleSectionKind);
+			break;
+
+		default:
+			add(ModelObjectKind_DocBlock, sizeof(DocBlock));
+		}
+
+		addString(block->m_blockKind);
+		addString(block->m_title);
+		addString(block->m_text);
+		addDocBlockList(block->m_childBlockList);
+	}
+}
+
+void
+ModelMemoryStats::addLocation(const Location& location)
+{
+	addString(location.m_file);
+	addString(location.m_bodyFile);
+}
+
+void
+ModelMemoryStats::addNamespaceContents(const NamespaceContents& contents)
+{
+	addArray(contents.m_groupArray);
+	addArray(contents.m_namespaceArray);
+	addArray(contents.m_enumArray);
+	addArray(contents.m_structArray);
+	addArray(contents.m_unionArray);
+	addArray(contents.m_classArray);
+	addArray(contents.m_interfaceArray);
+	addArray(contents.m_protocolArray);
+	addArray(contents.m_exceptionArray);
+	addArray(contents.m_serviceArray);
+	addArray(contents.m_singletonArray);
+	addArray(contents.m_typedefArray);
+	addArray(contents.m_variableArray);
+	addArray(contents.m_functionArray);
+	addArray(contents.m_propertyArray);
+	addArray(contents.m_eventArray);
+	addArray(contents.m_aliasArray);
+	addArray(contents.m_defineArray);
+	addArray(contents.m_footnoteArray);
+	addArray(contents.m_constructorArray);
+}
+
+//..............................................................................
+
+size_t
+LuaMemoryStats::getTotalSize()
+{
+	size_t size = 0;
+	for (size_t i = 0; i < LuaObjectKind_Count; i++)
+		size += m_tableEntryTable[i].m_size + m_stringEntryTable[i].m_size;
+
+	return size;
+}
+
+void
+LuaMemoryStats::clear()
+{
+	memset(m_tableEntryTable, 0, sizeof(m_tableEntryTable));
+	memset(m_stringEntryTable, 0, sizeof(m_stringEntryTable));
+	m_visitedSet.clear();
+}
+
+void
+LuaMemoryStats::collect(
+	lua_State* h,
+	const char* const* globalNameTable,
+	size_t globalCount
+	)
+{
+	clear();
+
+	for (size_t i = 0; i < globalCount; i++)
+	{
+		lua_getglobal(h, globalNameTable[i]);
+		if (lua_istable(h, -1))
+			addTable(h, -1);
+
+		lua_pop(h, 1);
+	}
+
+	m_visitedSet.clear();
+}
+
+static
+bool
+hasRawField(
+	lua_State* h,
+	int index, // absolute
+	const char* name
+	)
+{
+	lua_pushstring(h, name);
+	lua_rawget(h, index); // no __index -- don't trigger deferred descriptions
+	bool result = !lua_isnil(h, -1);
+	lua_pop(h, 1);
+	return result;
+}
+
+LuaObjectKind
+LuaMemoryStats::getTableKind(
+	lua_State* h,
+	int index
+	)
+{
+	if (hasRawField(h, index, "compoundKind"))
+		return LuaObjectKind_Compound;
+
+	lua_pushstring(h, "memberKind");
+	lua_rawget(h, index);
+	const char* memberKind = lua_type(h, -1) == LUA_TSTRING ? lua_tostring(h, -1) : NULL;
+	bool isEnumValue = memberKind && strcmp(memberKind, getMemberKindString(MemberKind_EnumValue)) == 0;
+	lua_pop(h, 1);
+
+	if (memberKind)
+		return isEnumValue ? LuaObjectKind_EnumValue : LuaObjectKind_Member;
+
+	return
+		hasRawField(h, index, "blockKind") ? LuaObjectKind_DocBlock :
+		hasRawField(h, index, "refKind") ? LuaObjectKind_RefText :
+		hasRawField(h, index, "declarationName") ? LuaObjectKind_Param :
+		hasRawField(h, index, "plainText") ? LuaObjectKind_LinkedText :
+		hasRawField(h, index, "bodyFile") ? LuaObjectKind_Location :
+		hasRawField(h, index, "isEmpty") ? LuaObjectKind_Description :
+		LuaObjectKind_Other;
+}
+
+void
+LuaMemoryStats::addTable(
+	lua_State* h,
+	int index
+	)
+{
+	if (index < 0)
+		index = lua_gettop(h) + index + 1;
+
+	if (!m_visitedSet.insert(lua_topointer(h, index)).second)
+		return;
+
+	luaL_checkstack(h, 4, "too deeply nested tables");
+
+	LuaObjectKind kind = getTableKind(h, index);
+
+#if (LUA_VERSION_NUM < 502)
+	size_t arrayLength = lua_objlen(h, index);
+#else
+	size_t arrayLength = lua_rawlen(h, index);
+#endif
+
+	size_t hashCount = 0;
+
+	lua_pushnil(h);
+	while (lua_next(h, index))
+	{
+		int keyType = lua_type(h, -2);
+		if (keyType == LUA_TSTRING)
+		{
+			addString(h, -2, kind);
+			hashCount++;
+		}
+		else if (keyType != LUA_TNUMBER)
+		{
+			hashCount++;
+		}
+		else
+		{
+			lua_Number key = lua_tonumber(h, -2); // doesn't convert the key in place
+			if (key < 1 || key > arrayLength || key != (size_t)key)
+				hashCount++;
+		}
+
+		switch (lua_type(h, -1))
+		{
+		case LUA_TSTRING:
+			addString(h, -1, kind);
+			break;
+
+		case LUA_TTABLE:
+			addTable(h, -1);
+			break;
+		}
+
+		lua_pop(h, 1);
+	}
+
+	size_t hashSize = 0;
+	if (hashCount)
+	{
+		size_t nodeCount = 1;
+		while (nodeCount < hashCount)
+			nodeCount <<= 1;
+
+		hashSize = nodeCount * HashNodeSize;
+	}
+
+	m_tableEntryTable[kind].m_count++;
+	m_tableEntryTable[kind].m_size += TableSize + arrayLength * ArraySlotSize + hashSize;
+}
+
+// Lua strings are interned (at least, the short ones), so the same pointer
+// means the same string object
+
+void
+LuaMemoryStats::addString(
+	lua_State* h,
+	int index,
+	LuaObjectKind kind
+	)
+{
+	size_t length;
+	const char* p = lua_tolstring(h, index, &length);
+	if (!m_visitedSet.insert(p).second)
+		return;
+
+	m_stringEntryTable[kind].m_count++;
+	m_stringEntryTable[kind].m_size += StringSize + length + 1;
+}
+
+//..............................................................................
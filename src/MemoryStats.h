@@ -0,0 +1,271 @@
+//..............................................................................
+//
+//  This file is part of the Doxyrest toolkit.
+//
+//  Doxyrest is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/doxyrest/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+#include <unordered_set>
+
+struct Module;
+struct Compound;
+struct Member;
+struct Param;
+struct EnumValue;
+struct Ref;
+struct LinkedText;
+struct DocBlock;
+struct Description;
+struct Location;
+struct NamespaceContents;
+class GlobalNamespace;
+
+//..............................................................................
+
+// per-type object counts and bytes of the documentation model (--stats); the
+// bytes are sizeof of the objects plus what they own directly (array payloads,
+// list boxes), allocator overhead not included
+
+enum ModelObjectKind
+{
+	ModelObjectKind_Compound,
+	ModelObjectKind_Member,
+	ModelObjectKind_Param,
+	ModelObjectKind_EnumValue,
+	ModelObjectKind_Ref,
+	ModelObjectKind_RefText,
+	ModelObjectKind_DocBlock,
+	ModelObjectKind_DocRefBlock,
+	ModelObjectKind_DocAnchorBlock,
+	ModelObjectKind_DocImageBlock,
+	ModelObjectKind_DocUlinkBlock,
+	ModelObjectKind_DocHeadingBlock,
+	ModelObjectKind_DocSectionBlock,
+	ModelObjectKind_DocSimpleSectionBlock,
+	ModelObjectKind_DescriptionSource,
+	ModelObjectKind_PathNode,
+	ModelObjectKind_Namespace,
+	ModelObjectKind_Array,      // array payloads & list boxes
+	ModelObjectKind_String,     // string payloads (shared buffers counted once)
+	ModelObjectKind_HashTable,  // intern & id tables
+	ModelObjectKind_Count,
+};
+
+const char*
+getModelObjectKindString(ModelObjectKind kind);
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+struct MemoryStatsEntry
+{
+	size_t m_count;
+	size_t m_size;
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+class ModelMemoryStats
+{
+protected:
+	MemoryStatsEntry m_entryTable[ModelObjectKind_Count];
+	std::unordered_set<const void*> m_stringBufferSet;
+
+public:
+	ModelMemoryStats()
+	{
+		clear();
+	}
+
+	bool
+	isEmpty()
+	{
+		return getTotalSize() == 0;
+	}
+
+	const MemoryStatsEntry&
+	getEntry(ModelObjectKind kind)
+	{
+		return m_entryTable[kind];
+	}
+
+	size_t
+	getTotalSize();
+
+	void
+	clear();
+
+	// globalNamespace is NULL before the namespace tree is built
+
+	void
+	collect(
+		Module* module,
+		GlobalNamespace* globalNamespace
+		);
+
+protected:
+	void
+	add(
+		ModelObjectKind kind,
+		size_t size,
+		size_t count = 1
+		)
+	{
+		m_entryTable[kind].m_count += count;
+		m_entryTable[kind].m_size += size;
+	}
+
+	template <typename T>
+	void
+	addArray(const sl::Array<T>& array)
+	{
+		if (!array.isEmpty())
+			add(ModelObjectKind_Array, array.getCount() * sizeof(T));
+	}
+
+	void
+	addString(const sl::String& string);
+
+	void
+	addStringList(const sl::BoxList<sl::String>& list);
+
+	void
+	addCompound(Compound* compound);
+
+	void
+	addMember(Member* member);
+
+	void
+	addParamList(const sl::List<Param>& list);
+
+	void
+	addEnumValue(EnumValue* enumValue);
+
+	void
+	addRefList(const sl::List<Ref>& list);
+
+	void
+	addLinkedText(const LinkedText& text);
+
+	void
+	addDescription(const Description& description);
+
+	void
+	addDocBlockList(const sl::List<DocBlock>& list);
+
+	void
+	addLocation(const Location& location);
+
+	void
+	addNamespaceContents(const NamespaceContents& contents);
+};
+
+//..............................................................................
+
+// a rough estimate of what the model takes in the Lua heap once exported:
+// all the tables reachable from the exported globals, classified by their
+// fields (compoundKind, memberKind, blockKind, etc.); table and string sizes
+// are those of 64-bit Lua 5.3/5.4
+
+enum LuaObjectKind
+{
+	LuaObjectKind_Compound,
+	LuaObjectKind_Member,
+	LuaObjectKind_EnumValue,
+	LuaObjectKind_Param,
+	LuaObjectKind_DocBlock,
+	LuaObjectKind_RefText,
+	LuaObjectKind_LinkedText,
+	LuaObjectKind_Description,
+	LuaObjectKind_Location,
+	LuaObjectKind_Other,  // arrays and everything else
+	LuaObjectKind_Count,
+};
+
+const char*
+getLuaObjectKindString(LuaObjectKind kind);
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+class LuaMemoryStats
+{
+protected:
+	enum
+	{
+		TableSize     = 56,
+		ArraySlotSize = 16,
+		HashNodeSize  = 32,
+		StringSize    = 24, // header only
+	};
+
+protected:
+	MemoryStatsEntry m_tableEntryTable[LuaObjectKind_Count];
+	MemoryStatsEntry m_stringEntryTable[LuaObjectKind_Count];
+	std::unordered_set<const void*> m_visitedSet;
+
+public:
+	LuaMemoryStats()
+	{
+		clear();
+	}
+
+	bool
+	isEmpty()
+	{
+		return getTotalSize() == 0;
+	}
+
+	const MemoryStatsEntry&
+	getTableEntry(LuaObjectKind kind)
+	{
+		return m_tableEntryTable[kind];
+	}
+
+	const MemoryStatsEntry&
+	getStringEntry(LuaObjectKind kind)
+	{
+		return m_stringEntryTable[kind];
+	}
+
+	size_t
+	getTotalSize();
+
+	void
+	clear();
+
+	// walks the tables reachable from the given globals
+
+	void
+	collect(
+		lua_State* h,
+		const char* const* globalNameTable,
+		size_t globalCount
+		);
+
+protected:
+	void
+	addTable(
+		lua_State* h,
+		int index
+		);
+
+	void
+	addString(
+		lua_State* h,
+		int index,
+		LuaObjectKind kind
+		);
+
+	LuaObjectKind
+	getTableKind(
+		lua_State* h,
+		int index
+		);
+};
+
+//..............................................................................
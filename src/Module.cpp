@@ -11,26 +11,104 @@
 
 #include "pch.h"
 #include "Module.h"
+#include "DoxyXmlParser.h"
 #include "CmdLine.h"
 
 //..............................................................................
 
 sl::String
-createPath(
-	const sl::StringRef& name,
+PathNode::getPath()
+{
+	sl::String path;
+	char* p = path.createBuffer(m_length);
+	if (!p)
+		return path;
+
+	p += m_length;
+
+	// fill the buffer backwards
+
+	for (PathNode* node = this; node; node = node->m_parent)
+	{
+		size_t nameLength = node->m_name.getLength();
+		p -= nameLength;
+		memcpy(p, node->m_name.cp(), nameLength);
+
+		if (node->m_parent && node->m_parent->m_length)
+			*--p = '/';
+	}
+
+	ASSERT(p == path.cp());
+	return path;
+}
+
+sl::String
+PathNode::getFileNamePath()
+{
+	sl::String path = getPath();
+	size_t length = path.getLength();
+	char* p = path.getBuffer();
+
+	// collapse operator signs: "foo/operator+=" -> "foo/operator"
+
+	size_t nameLength = m_name.getLength();
+	if (m_parent && m_parent->m_length && nameLength > 8 && m_name.isPrefix("operator"))
+	{
+		const char* name = p + length - nameLength;
+		const char* end = p + length;
+		const char* sign = name + 8;
+
+		while (sign < end && (isspace((uchar_t)*sign) || ispunct((uchar_t)*sign)))
+			sign++;
+
+		if (sign == end)
+		{
+			length -= nameLength - 8;
+			path.setReducedLength(length);
+		}
+	}
+
+	for (size_t i = 0; i < length; i++)
+		if (p[i] == '/')
+			p[i] = '_';
+
+	return path;
+}
+
+PathNode*
+PathTable::addNode(
+	PathNode* parent,
+	const sl::String& name
+	)
+{
+	PathNode* node = AXL_MEM_NEW(PathNode);
+	node->m_parent = parent;
+	node->m_name = name;
+	node->m_length = parent && parent->m_length ?
+		parent->m_length + 1 + name.getLength() :
+		name.getLength();
+
+	m_nodeList.insertTail(node);
+	return node;
+}
+
+PathNode*
+preparePathNode(
+	PathTable* pathTable,
+	PathNode** node,
+	const sl::String& name,
 	Namespace* parentNamespace
 	)
 {
-	if (!parentNamespace)
-		return name;
+	if (*node)
+		return *node;
 
-	parentNamespace->m_compound->preparePath();
-	sl::String path = parentNamespace->m_compound->m_path;
-	if (!path.isEmpty())
-		path += '/';
+	PathNode* parentNode = parentNamespace ?
+		parentNamespace->m_compound->preparePathNode(pathTable) :
+		NULL;
 
-	path += name;
-	return path;
+	*node = pathTable->addNode(parentNode, name);
+	return *node;
 }
 
 template <typename T>
@@ -172,11 +250,14 @@ DocRefBlock::luaExport(lua::LuaState* luaState)
 
 	if (m_refKind == RefKind_Compound)
 	{
-		Compound* compound = m_module->m_compoundMap.findValue(m_id, NULL);
+		Compound* compound = m_module->getCompound(m_handle);
 		if (compound && compound->m_compoundKind == CompoundKind_File) // we don't export files, so remove reference
 		{
-			m_blockKind = "computeroutput";
+			// don't modify the block itself -- the model may be exported by
+			// several generators running in parallel
+
 			DocBlock::luaExportMembers(luaState);
+			luaState->setMemberString("blockKind", "computeroutput");
 			return;
 		}
 	}
@@ -272,15 +353,126 @@ DocSimpleSectionBlock::luaExport(lua::LuaState* luaState)
 
 //.............................................................................
 
+// several generators may render the same model in parallel (multi-config
+// runs); deferred descriptions are the only part of the model which changes
+// during rendering. each module has its own lock, so unrelated models (e.g.
+// batch projects) don't wait for each other
+
+bool
+Description::load()
+{
+	if (!m_source) // parsed along with the compound
+		return true;
+
+	Module* module = m_source->m_module;
+	bool result = true;
+
+	module->m_deferredDescriptionLock.lock();
+
+	if (!m_isLoaded)
+	{
+		result = DoxyXmlParser::parseDeferredDescription(this);
+		m_isLoaded = true; // don't retry on errors
+
+		if (module->m_isStreaming)
+			module->m_loadedDescriptionArray.append(this);
+	}
+
+	module->m_deferredDescriptionLock.unlock();
+	return result;
+}
+
 void
 Description::luaExport(lua::LuaState* luaState)
 {
+	bool isDescriptionEmpty;
+	bool isLoaded;
+
+	if (!m_source)
+	{
+		isDescriptionEmpty = isEmpty();
+		isLoaded = true;
+	}
+	else
+	{
+		Module* module = m_source->m_module;
+		module->m_deferredDescriptionLock.lock();
+		isDescriptionEmpty = isEmpty();
+		isLoaded = m_isLoaded || !m_hasContent;
+		module->m_deferredDescriptionLock.unlock();
+	}
+
 	luaState->createTable();
 
-	luaState->setMemberBoolean("isEmpty", isEmpty ());
+	luaState->setMemberBoolean("isEmpty", isDescriptionEmpty);
+
+	if (isLoaded)
+	{
+		luaExportList(luaState, m_docBlockList);
+		luaState->setMember("docBlockList");
+		return;
+	}
+
+	// docBlockList will be created on first access
+
+	lua_State* h = *luaState;
+
+	lua_pushlightuserdata(h, this);
+	lua_setfield(h, -2, "__description");
+
+	if (luaL_newmetatable(h, "doxyrest.DeferredDescription"))
+	{
+		lua_pushcfunction(h, index_lua);
+		lua_setfield(h, -2, "__index");
+	}
+
+	lua_setmetatable(h, -2);
+}
+
+int
+Description::index_lua(lua_State* h)
+{
+	const char* key = lua_tostring(h, 2);
+	if (!key || strcmp(key, "docBlockList") != 0)
+		return 0;
+
+	lua_getfield(h, 1, "__description");
+	Description* self = (Description*)lua_touserdata(h, -1);
+	lua_pop(h, 1);
+
+	if (!self)
+		return 0;
+
+	Module* module = self->m_source ? self->m_source->m_module : NULL;
 
-	luaExportList(luaState, m_docBlockList);
-	luaState->setMember("docBlockList");
+	bool result = self->load();
+	if (!result)
+		fprintf(stderr, "warning: %s\n", err::getLastErrorDescription().sz());
+
+	if (module && module->m_isStreaming)
+	{
+		// remember the table, so the cached docBlockList can be dropped later
+
+		lua_getfield(h, LUA_REGISTRYINDEX, DOXYREST_LOADED_DESCRIPTIONS_KEY);
+		if (lua_isnil(h, -1))
+		{
+			lua_pop(h, 1);
+			lua_newtable(h);
+			lua_pushvalue(h, -1);
+			lua_setfield(h, LUA_REGISTRYINDEX, DOXYREST_LOADED_DESCRIPTIONS_KEY);
+		}
+
+		lua_pushvalue(h, 1);
+		lua_pushboolean(h, true);
+		lua_rawset(h, -3);
+		lua_pop(h, 1);
+	}
+
+	lua::LuaNonOwnerState luaState(h);
+	luaExportList(&luaState, self->m_docBlockList);
+	lua_pushvalue(h, -1);
+	lua_setfield(h, 1, "docBlockList"); // cache it in the description table
+	return 1;
 }
 
 //.............................................................................
@@ -337,6 +529,7 @@ EnumValue::EnumValue()
 	m_protectionKind = ProtectionKind_Undefined;
 	m_parentEnum = NULL;
 	m_isDuplicate = false;
+	m_handle = -1;
 }
 
 void
@@ -349,8 +542,8 @@ EnumValue::luaExport(lua::LuaState* luaState)
 	luaState->setMemberString("name", m_name);
 	luaState->setMemberString("memberKind", getMemberKindString(MemberKind_EnumValue));
 
-	m_parentEnum->preparePath();
-	sl::String path = m_parentEnum->m_path;
+	ASSERT(m_parentEnum->m_pathNode);
+	sl::String path = m_parentEnum->m_pathNode->getPath();
 	if (!path.isEmpty())
 		path += '/';
 
@@ -453,6 +646,8 @@ Member::Member()
 	m_virtualKind = VirtualKind_NonVirtual;
 	m_flags = 0;
 	m_cacheIdx = -1;
+	m_handle = -1;
+	m_pathNode = NULL;
 }
 
 void
@@ -491,8 +686,9 @@ Member::luaExport(lua::LuaState* luaState)
 	luaExportStringList(luaState, m_importList);
 	luaState->setMember("importArray");
 
-	preparePath();
-	luaState->setMemberString("path",  m_path);
+	ASSERT(m_pathNode);
+	luaState->setMemberString("path", m_pathNode->getPath());
+	luaState->setMemberString("fileNamePath", m_pathNode->getFileNamePath());
 
 	switch (m_memberKind)
 	{
@@ -587,6 +783,12 @@ Member::luaExport(lua::LuaState* luaState)
 	m_inBodyDescription.luaExport(luaState);
 	luaState->setMember("inBodyDescription");
 
+	if (!m_usedByArray.isEmpty())
+	{
+		luaExportArray(luaState, m_usedByArray);
+		luaState->setMember("usedByArray");
+	}
+
 	m_location.luaExport(luaState);
 	luaState->setMember("location");
 }
@@ -598,6 +800,8 @@ Compound::Compound()
 	m_selfNamespace = NULL;
 	m_parentNamespace = NULL;
 	m_groupCompound = NULL;
+	m_handle = -1;
+	m_pathNode = NULL;
 	m_compoundKind = CompoundKind_Undefined;
 	m_languageKind = LanguageKind_Undefined;
 	m_protectionKind = ProtectionKind_Public;
@@ -607,7 +811,10 @@ Compound::Compound()
 	m_isDuplicate = false;
 	m_isSubPage = false;
 	m_hasGlobalNamespace = false;
+	m_isBaseTypeClosureReady = false;
+	m_isBaseTypeClosurePending = false;
 	m_cacheIdx = -1;
+	m_mark = 0;
 }
 
 void
@@ -643,8 +850,9 @@ Compound::luaExport(lua::LuaState* luaState)
 		luaState->setMember("group");
 	}
 
-	preparePath();
-	luaState->setMemberString("path", m_path);
+	ASSERT(m_pathNode);
+	luaState->setMemberString("path", m_pathNode->getPath());
+	luaState->setMemberString("fileNamePath", m_pathNode->getFileNamePath());
 
 	size_t count;
 
@@ -679,6 +887,9 @@ Compound::luaExport(lua::LuaState* luaState)
 		luaExportArray(luaState, m_baseTypeArray);
 		luaState->setMember("baseTypeArray");
 
+		luaExportArray(luaState, m_baseTypeClosureArray);
+		luaState->setMember("baseTypeClosureArray");
+
 		count = m_baseTypeProtectionArray.getCount();
 		luaState->createTable(count);
 		for (size_t i = 0; i < count; i++)
@@ -699,6 +910,12 @@ Compound::luaExport(lua::LuaState* luaState)
 		break;
 	}
 
+	if (!m_usedByArray.isEmpty())
+	{
+		luaExportArray(luaState, m_usedByArray);
+		luaState->setMember("usedByArray");
+	}
+
 	luaExportStringList(luaState, m_importList);
 	luaState->setMember("importArray");
 
@@ -715,6 +932,51 @@ Compound::luaExport(lua::LuaState* luaState)
 		m_selfNamespace->luaExportMembers(luaState);
 }
 
+void
+Compound::prepareBaseTypeClosure(size_t* mark)
+{
+	if (m_isBaseTypeClosureReady || m_isBaseTypeClosurePending) // pending means a cycle in the hierarchy
+		return;
+
+	m_isBaseTypeClosurePending = true;
+
+	// closures of the bases must be ready before we start marking
+
+	size_t count = m_baseTypeArray.getCount();
+	for (size_t i = 0; i < count; i++)
+		m_baseTypeArray[i]->prepareBaseTypeClosure(mark);
+
+	// the order is the same as in a depth-first walk: bases of a base go
+	// before the base itself; each compound is added only once (diamonds)
+
+	size_t thisMark = ++*mark;
+	m_mark = thisMark;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		Compound* baseType = m_baseTypeArray[i];
+		if (baseType->m_compoundKind == CompoundKind_Undefined || baseType->m_mark == thisMark)
+			continue;
+
+		size_t closureCount = baseType->m_baseTypeClosureArray.getCount();
+		for (size_t j = 0; j < closureCount; j++)
+		{
+			Compound* closureType = baseType->m_baseTypeClosureArray[j];
+			if (closureType->m_mark != thisMark)
+			{
+				closureType->m_mark = thisMark;
+				m_baseTypeClosureArray.append(closureType);
+			}
+		}
+
+		baseType->m_mark = thisMark;
+		m_baseTypeClosureArray.append(baseType);
+	}
+
+	m_isBaseTypeClosurePending = false;
+	m_isBaseTypeClosureReady = true;
+}
+
 void
 Compound::unqualifyName()
 {
@@ -806,6 +1068,87 @@ Compound::createTemplateSpecParam(const sl::StringRef& name)
 
 //..............................................................................
 
+void
+Module::clearExportCache()
+{
+	sl::Iterator<Compound> it = m_compoundList.getHead();
+	for (; it; it++)
+	{
+		it->m_cacheIdx = -1;
+
+		sl::Iterator<Member> memberIt = it->m_memberList.getHead();
+		for (; memberIt; memberIt++)
+			memberIt->m_cacheIdx = -1;
+	}
+}
+
+void
+Module::unloadDescriptions()
+{
+	m_deferredDescriptionLock.lock();
+
+	size_t count = m_loadedDescriptionArray.getCount();
+	if (count > m_maxLoadedDescriptionCount)
+		m_maxLoadedDescriptionCount = count;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		Description* description = m_loadedDescriptionArray[i];
+		description->m_title.clear();
+		description->m_docBlockList.clear();
+		description->m_isLoaded = false; // will be re-parsed if needed again
+	}
+
+	m_unloadedDescriptionCount += count;
+	m_loadedDescriptionArray.clear();
+
+	m_deferredDescriptionLock.unlock();
+}
+
+const sl::String&
+Module::intern(const sl::StringRef& string)
+{
+	static sl::String emptyString;
+
+	if (string.isEmpty())
+		return emptyString;
+
+	m_internStats.m_requestCount++;
+
+	sl::StringHashTableIterator<bool> it = m_internTable.visit(string);
+	if (it->m_value)
+	{
+		m_internStats.m_hitCount++;
+		m_internStats.m_savedSize += string.getLength() + 1;
+	}
+	else
+	{
+		it->m_value = true;
+	}
+
+	return it->getKey();
+}
+
+size_t
+Module::getHandle(const sl::StringRef& id)
+{
+	if (id.isEmpty())
+		return -1;
+
+	sl::StringHashTableIterator<size_t> it = m_handleMap.visit(id);
+	if (it->m_value)
+		return it->m_value - 1;
+
+	size_t handle = m_handleTable.getCount();
+	it->m_value = handle + 1; // 0 means "just created"
+
+	HandleEntry entry = { 0 };
+	m_handleTable.append(entry);
+	return handle;
+}
+
+//..............................................................................
+
 bool
 NamespaceContents::add(Compound* compound)
 {
@@ -1086,7 +1429,8 @@ bool
 GlobalNamespace::build(
 	Module* module,
 	const sl::StringRef& auxCompoundId,
-	const sl::StringRef& footnoteMemberPrefix
+	const sl::StringRef& footnoteMemberPrefix,
+	size_t threadCount
 	)
 {
 	clear();
@@ -1126,7 +1470,7 @@ GlobalNamespace::build(
 			}
 			else
 			{
-				Member* member = module->m_memberMap.findValue(memberIt->m_id, NULL);
+				Member* member = module->getMember(memberIt->m_handle);
 				if (member && member->m_parentCompound->isMemberGroupAllowed())
 					member->m_groupCompound = compound;
 			}
@@ -1135,7 +1479,7 @@ GlobalNamespace::build(
 		sl::Iterator<Ref> refIt = compound->m_innerRefList.getHead();
 		for (; refIt; refIt++)
 		{
-			Compound* innerCompound = module->m_compoundMap.findValue(refIt->m_id, NULL);
+			Compound* innerCompound = module->getCompound(refIt->m_handle);
 			if (innerCompound)
 				innerCompound->m_groupCompound = compound;
 		}
@@ -1143,7 +1487,7 @@ GlobalNamespace::build(
 
 	if (!auxCompoundId.isEmpty())
 	{
-		m_auxCompound = module->m_compoundMap.findValue(auxCompoundId, NULL);
+		m_auxCompound = module->getCompound(module->findHandle(auxCompoundId));
 		if (m_auxCompound && m_auxCompound->m_groupCompound)
 			m_auxCompound->m_groupCompound->m_hasGlobalNamespace = true;
 	}
@@ -1165,7 +1509,239 @@ GlobalNamespace::build(
 
 	// resolve inner, base and derived references and add members
 
+	bool result = threadCount > 1 && count > 1 ?
+		buildNamespacesParallel(module, threadCount) :
+		buildNamespaces(module);
+
+	if (!result)
+		return false;
+
+	// resolve sub pages
+
+	count = module->m_pageArray.getCount();
 	for (size_t i = 0; i < count; i++)
+	{
+		Compound* compound = module->m_pageArray[i];
+
+		sl::Iterator<Ref> refIt = compound->m_innerRefList.getHead();
+		for (; refIt; refIt++)
+		{
+			Compound* subPage = module->getCompound(refIt->m_handle);
+			if (!subPage)
+			{
+				fprintf(stderr, "warning: can't find subpage refid: %s\n", refIt->m_id.sz());
+				continue;
+			}
+
+			compound->m_subPageArray.append(subPage);
+			subPage->m_isSubPage = true;
+		}
+	}
+
+	removeSubPages(&module->m_pageArray);
+
+	// add leftovers to the global namespace
+
+	sl::Iterator<Compound> compoundIt = module->m_compoundList.getHead();
+	for (; compoundIt; compoundIt++)
+	{
+		sl::Iterator<Member> memberIt;
+
+		switch (compoundIt->m_compoundKind)
+		{
+		case CompoundKind_Undefined: // template base type or incomplete compound
+			break;
+
+		case CompoundKind_Group:
+			if (*compoundIt != m_auxCompound &&
+				(!compoundIt->m_briefDescription.isEmpty() ||
+				!compoundIt->m_detailedDescription.isEmpty())) // ensure documented group is added to the tree
+				getGroupNamespace(module, *compoundIt);
+
+			break;
+
+		case CompoundKind_File:
+			memberIt = compoundIt->m_memberList.getHead();
+
+			for (; memberIt; memberIt++)
+			{
+				Compound* memberCompound;
+
+				if (memberIt->m_flags & MemberFlag_Duplicate)
+					continue;
+
+				switch (memberIt->m_memberKind)
+				{
+				case MemberKind_Interface:
+				case MemberKind_Service:
+					memberCompound = createMemberCompound(*memberIt);
+					addNewCompound(module, memberCompound);
+					add(memberCompound);
+
+					if (memberCompound->m_groupCompound)
+					{
+						Namespace* groupNspace = getGroupNamespace(module, memberCompound->m_groupCompound);
+						groupNspace->add(memberCompound);
+					}
+
+					break;
+
+				default:
+					add(*memberIt, NULL);
+					if (memberIt->m_groupCompound)
+					{
+						Namespace* groupNspace = getGroupNamespace(module, memberIt->m_groupCompound);
+						groupNspace->add(*memberIt, NULL);
+					}
+				}
+			}
+			break;
+
+		default:
+			if (!compoundIt->m_parentNamespace)
+			{
+				add(*compoundIt);
+				if (compoundIt->m_groupCompound)
+				{
+					Namespace* groupNspace = getGroupNamespace(module, compoundIt->m_groupCompound);
+					groupNspace->add(*compoundIt);
+				}
+			}
+		}
+	}
+
+	buildUsedByIndex(module);
+
+	// transitive base closures (memoized over the inheritance graph)
+
+	size_t closureMark = 0;
+	sl::Iterator<Compound> closureIt = module->m_compoundList.getHead();
+	for (; closureIt; closureIt++)
+		closureIt->prepareBaseTypeClosure(&closureMark);
+
+	// now that all the parent namespaces are known, build the path table
+
+	compoundIt = module->m_compoundList.getHead();
+	for (; compoundIt; compoundIt++)
+	{
+		compoundIt->preparePathNode(&module->m_pathTable);
+
+		sl::Iterator<Member> memberIt = compoundIt->m_memberList.getHead();
+		for (; memberIt; memberIt++)
+			memberIt->preparePathNode(&module->m_pathTable);
+	}
+
+	return true;
+}
+
+class NamespaceBuildThread: public sys::ThreadImpl<NamespaceBuildThread>
+{
+public:
+	GlobalNamespace* m_globalNamespace;
+	Module* m_module;
+	size_t m_begin;
+	size_t m_end;
+	NamespaceBuildBuffer m_buffer;
+	bool m_result;
+
+public:
+	void
+	threadFunc()
+	{
+		m_result = m_globalNamespace->buildNamespaceRange(m_module, m_begin, m_end, &m_buffer);
+	}
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+bool
+GlobalNamespace::buildNamespaces(Module* module)
+{
+	NamespaceBuildBuffer buffer;
+	bool result = buildNamespaceRange(module, 0, module->m_namespaceArray.getCount(), &buffer);
+	applyNamespaceBuildBuffer(module, &buffer);
+
+	if (!result)
+		err::setFormatStringError("%s", buffer.m_errorString.sz());
+
+	return result;
+}
+
+bool
+GlobalNamespace::buildNamespacesParallel(
+	Module* module,
+	size_t threadCount
+	)
+{
+	size_t count = module->m_namespaceArray.getCount();
+	if (threadCount > count)
+		threadCount = count;
+
+	// each thread handles a contiguous range of compounds; buffers are applied
+	// in the order of ranges, which reproduces the single-threaded order
+
+	sl::Array<NamespaceBuildThread*> threadArray;
+	threadArray.setCount(threadCount);
+
+	size_t begin = 0;
+	for (size_t i = 0; i < threadCount; i++)
+	{
+		size_t end = count * (i + 1) / threadCount;
+
+		NamespaceBuildThread* thread = AXL_MEM_NEW(NamespaceBuildThread);
+		thread->m_globalNamespace = this;
+		thread->m_module = module;
+		thread->m_begin = begin;
+		thread->m_end = end;
+		thread->m_result = false;
+		threadArray[i] = thread;
+		begin = end;
+	}
+
+	for (size_t i = 1; i < threadCount; i++)
+		threadArray[i]->start();
+
+	threadArray[0]->threadFunc(); // the calling thread takes the first range
+
+	for (size_t i = 1; i < threadCount; i++)
+		threadArray[i]->waitAndClose();
+
+	bool result = true;
+
+	for (size_t i = 0; i < threadCount; i++)
+	{
+		NamespaceBuildThread* thread = threadArray[i];
+		applyNamespaceBuildBuffer(module, &thread->m_buffer); // takes ownership of new compounds
+
+		if (result && !thread->m_result)
+		{
+			err::setFormatStringError("%s", thread->m_buffer.m_errorString.sz());
+			result = false;
+		}
+
+		AXL_MEM_DELETE(thread);
+	}
+
+	return result;
+}
+
+bool
+GlobalNamespace::buildNamespaceRange(
+	Module* module,
+	size_t begin,
+	size_t end,
+	NamespaceBuildBuffer* buffer
+	)
+{
+	// must not touch anything shared between compounds: group namespaces,
+	// lists of the module and arrays of other compounds are updated later,
+	// in applyNamespaceBuildBuffer
+
+	size_t handleCount = module->m_handleTable.getCount();
+	sl::Array<size_t> derivedMarkArray; // handle -> (index of the last compound referencing it as derived) + 1
+	derivedMarkArray.setCountZeroConstruct(handleCount);
+
+	for (size_t i = begin; i < end; i++)
 	{
 		Compound* compound = module->m_namespaceArray[i];
 		Namespace* nspace = compound->m_selfNamespace;
@@ -1185,16 +1761,14 @@ GlobalNamespace::build(
 			{
 			case MemberKind_Interface:
 			case MemberKind_Service:
-				memberCompound = createMemberCompound(module, *memberIt);
+				memberCompound = createMemberCompound(*memberIt);
+				buffer->m_newCompoundArray.append(memberCompound);
 
 				nspace->add(memberCompound);
 				memberCompound->m_parentNamespace = nspace; // namespace, not group!
 
 				if (memberCompound->m_groupCompound)
-				{
-					Namespace* groupNspace = getGroupNamespace(module, memberCompound->m_groupCompound);
-					groupNspace->add(memberCompound);
-				}
+					buffer->addGroupEntry(memberCompound->m_groupCompound, memberCompound);
 
 				break;
 
@@ -1203,20 +1777,17 @@ GlobalNamespace::build(
 				memberIt->m_parentNamespace = nspace; // namespace, not group!
 
 				if (memberIt->m_groupCompound)
-				{
-					Namespace* groupNspace = getGroupNamespace(module, memberIt->m_groupCompound);
-					groupNspace->add(*memberIt, compound);
-				}
+					buffer->addGroupEntry(memberIt->m_groupCompound, *memberIt, compound);
 			}
 		}
 
 		sl::Iterator<Ref> refIt = compound->m_innerRefList.getHead();
 		for (; refIt; refIt++)
 		{
-			Compound* innerCompound = module->m_compoundMap.findValue(refIt->m_id, NULL);
+			Compound* innerCompound = module->getCompound(refIt->m_handle);
 			if (!innerCompound)
 			{
-				fprintf(stderr, "warning: can't find inner compound refid: %s\n", refIt->m_id.sz());
+				buffer->m_warnings.appendFormat("warning: can't find inner compound refid: %s\n", refIt->m_id.sz());
 				continue;
 			}
 
@@ -1226,14 +1797,9 @@ GlobalNamespace::build(
 			if (innerCompound->m_groupCompound)
 			{
 				if (compound->isMemberGroupAllowed())
-				{
-					Namespace* groupNspace = getGroupNamespace(module, innerCompound->m_groupCompound);
-					groupNspace->add(innerCompound);
-				}
+					buffer->addGroupEntry(innerCompound->m_groupCompound, innerCompound);
 				else
-				{
 					innerCompound->m_groupCompound = NULL;
-				}
 			}
 		}
 
@@ -1251,36 +1817,42 @@ GlobalNamespace::build(
 				baseCompound->m_id = refIt->m_id;
 				baseCompound->m_importId = refIt->m_importId;
 				baseCompound->m_name = refIt->m_text;
-				module->m_compoundList.insertTail(baseCompound);
+				buffer->m_newCompoundArray.append(baseCompound);
 			}
 			else
 			{
-				baseCompound = module->m_compoundMap.findValue(refIt->m_id, NULL);
+				baseCompound = module->getCompound(refIt->m_handle);
 				if (!baseCompound)
 				{
-					err::setFormatStringError("can't find base compound refid: %s\n", refIt->m_id.sz());
+					buffer->m_errorString.format("can't find base compound refid: %s\n", refIt->m_id.sz());
 					return false;
 				}
 
-				baseCompound->m_derivedTypeArray_auto.append(compound);
+				DerivedTypeEntry entry = { baseCompound, compound };
+				buffer->m_derivedTypeArray.append(entry);
 			}
 
 			compound->m_baseTypeArray.append(baseCompound);
 			compound->m_baseTypeProtectionArray.append(refIt->m_protectionKind);
 		}
 
-		sl::StringHashTable<bool> idMap; // derivedcompoundref may specify the same class multiple types -- we don't want that
+		// derivedcompoundref may specify the same class multiple types -- we don't want that
 
 		refIt = compound->m_derivedRefList.getHead();
 		for (; refIt; refIt++)
 		{
-			if (!idMap.addIfNotExists(refIt->m_id, true))
-				continue;
+			if (refIt->m_handle < handleCount)
+			{
+				if (derivedMarkArray[refIt->m_handle] == i + 1)
+					continue;
 
-			Compound* derivedCompound = module->m_compoundMap.findValue(refIt->m_id, NULL);
+				derivedMarkArray[refIt->m_handle] = i + 1;
+			}
+
+			Compound* derivedCompound = module->getCompound(refIt->m_handle);
 			if (!derivedCompound)
 			{
-				fprintf(stderr, "warning: can't find derived compound refid: %s\n", refIt->m_id.sz());
+				buffer->m_warnings.appendFormat("warning: can't find derived compound refid: %s\n", refIt->m_id.sz());
 				continue;
 			}
 
@@ -1288,100 +1860,182 @@ GlobalNamespace::build(
 		}
 	}
 
-	// resolve sub pages
+	return true;
+}
 
-	count = module->m_pageArray.getCount();
+void
+GlobalNamespace::applyNamespaceBuildBuffer(
+	Module* module,
+	NamespaceBuildBuffer* buffer
+	)
+{
+	if (!buffer->m_warnings.isEmpty())
+		fprintf(stderr, "%s", buffer->m_warnings.sz());
+
+	size_t count = buffer->m_newCompoundArray.getCount();
 	for (size_t i = 0; i < count; i++)
-	{
-		Compound* compound = module->m_pageArray[i];
+		addNewCompound(module, buffer->m_newCompoundArray[i]);
 
-		sl::Iterator<Ref> refIt = compound->m_innerRefList.getHead();
-		for (; refIt; refIt++)
-		{
-			Compound* subPage = module->m_compoundMap.findValue(refIt->m_id, NULL);
-			if (!subPage)
-			{
-				fprintf(stderr, "warning: can't find subpage refid: %s\n", refIt->m_id.sz());
-				continue;
-			}
+	count = buffer->m_groupEntryArray.getCount();
+	for (size_t i = 0; i < count; i++)
+	{
+		const GroupEntry& entry = buffer->m_groupEntryArray[i];
+		Namespace* groupNspace = getGroupNamespace(module, entry.m_groupCompound);
 
-			compound->m_subPageArray.append(subPage);
-			subPage->m_isSubPage = true;
-		}
+		if (entry.m_member)
+			groupNspace->add(entry.m_member, entry.m_thisCompound);
+		else
+			groupNspace->add(entry.m_compound);
 	}
 
-	removeSubPages(&module->m_pageArray);
+	count = buffer->m_derivedTypeArray.getCount();
+	for (size_t i = 0; i < count; i++)
+	{
+		const DerivedTypeEntry& entry = buffer->m_derivedTypeArray[i];
+		entry.m_baseCompound->m_derivedTypeArray_auto.append(entry.m_derivedCompound);
+	}
+}
 
-	// add leftovers to the global namespace
+// collects the targets of all the references found in a member (in its types
+// and descriptions) and appends the member to their usedByArray-s
 
-	sl::Iterator<Compound> compoundIt = module->m_compoundList.getHead();
-	for (; compoundIt; compoundIt++)
+class UsedByIndexer
+{
+protected:
+	Module* m_module;
+	sl::Array<size_t> m_markArray; // handle -> (index of the last user referencing it) + 1
+	Member* m_user;
+	size_t m_userIdx;
+
+public:
+	UsedByIndexer(Module* module)
 	{
-		sl::Iterator<Member> memberIt;
+		m_module = module;
+		m_markArray.setCountZeroConstruct(module->m_handleTable.getCount());
+		m_user = NULL;
+		m_userIdx = 0;
+	}
 
-		switch (compoundIt->m_compoundKind)
-		{
-		case CompoundKind_Undefined: // template base type or incomplete compound
-			break;
+	void
+	addUser(Member* member);
 
-		case CompoundKind_Group:
-			if (*compoundIt != m_auxCompound &&
-				(!compoundIt->m_briefDescription.isEmpty() ||
-				!compoundIt->m_detailedDescription.isEmpty())) // ensure documented group is added to the tree
-				getGroupNamespace(module, *compoundIt);
+protected:
+	void
+	addRef(size_t handle);
 
-			break;
+	void
+	addLinkedText(const LinkedText& text);
 
-		case CompoundKind_File:
-			memberIt = compoundIt->m_memberList.getHead();
+	void
+	addParamList(const sl::List<Param>& list);
 
-			for (; memberIt; memberIt++)
-			{
-				Compound* memberCompound;
+	void
+	addDocBlockList(const sl::List<DocBlock>& list);
 
-				if (memberIt->m_flags & MemberFlag_Duplicate)
-					continue;
+	void
+	addDescription(const Description& description);
+};
 
-				switch (memberIt->m_memberKind)
-				{
-				case MemberKind_Interface:
-				case MemberKind_Service:
-					memberCompound = createMemberCompound(module, *memberIt);
-					add(memberCompound);
+void
+UsedByIndexer::addUser(Member* member)
+{
+	m_user = member;
+	m_userIdx++;
+
+	addLinkedText(member->m_type);
+	addLinkedText(member->m_initializer);
+	addLinkedText(member->m_exceptions);
+	addParamList(member->m_paramList);
+	addParamList(member->m_templateParamList);
+	addDescription(member->m_briefDescription);
+	addDescription(member->m_detailedDescription);
+	addDescription(member->m_inBodyDescription);
+}
 
-					if (memberCompound->m_groupCompound)
-					{
-						Namespace* groupNspace = getGroupNamespace(module, memberCompound->m_groupCompound);
-						groupNspace->add(memberCompound);
-					}
+void
+UsedByIndexer::addRef(size_t handle)
+{
+	HandleEntry* entry = m_module->getHandleEntry(handle);
+	if (!entry || m_markArray[handle] == m_userIdx)
+		return;
 
-					break;
+	m_markArray[handle] = m_userIdx;
 
-				default:
-					add(*memberIt, NULL);
-					if (memberIt->m_groupCompound)
-					{
-						Namespace* groupNspace = getGroupNamespace(module, memberIt->m_groupCompound);
-						groupNspace->add(*memberIt, NULL);
-					}
-				}
-			}
-			break;
+	if (entry->m_compound)
+		entry->m_compound->m_usedByArray.append(m_user);
 
-		default:
-			if (!compoundIt->m_parentNamespace)
-			{
-				add(*compoundIt);
-				if (compoundIt->m_groupCompound)
-				{
-					Namespace* groupNspace = getGroupNamespace(module, compoundIt->m_groupCompound);
-					groupNspace->add(*compoundIt);
-				}
-			}
-		}
+	if (entry->m_member && entry->m_member != m_user)
+		entry->m_member->m_usedByArray.append(m_user);
+}
+
+void
+UsedByIndexer::addLinkedText(const LinkedText& text)
+{
+	sl::ConstIterator<RefText> it = text.m_refTextList.getHead();
+	for (; it; it++)
+		addRef(it->m_handle);
+}
+
+void
+UsedByIndexer::addParamList(const sl::List<Param>& list)
+{
+	sl::ConstIterator<Param> it = list.getHead();
+	for (; it; it++)
+	{
+		addLinkedText(it->m_type);
+		addLinkedText(it->m_defaultValue);
+		addLinkedText(it->m_typeConstraint);
 	}
+}
 
-	return true;
+void
+UsedByIndexer::addDescription(const Description& description)
+{
+	if (!description.isDeferred())
+	{
+		addDocBlockList(description.m_docBlockList);
+		return;
+	}
+
+	// don't force parsing of deferred descriptions -- use the ref targets
+	// recorded along with the byte range
+
+	size_t count = description.m_refHandleArray.getCount();
+	for (size_t i = 0; i < count; i++)
+		addRef(description.m_refHandleArray[i]);
+}
+
+void
+UsedByIndexer::addDocBlockList(const sl::List<DocBlock>& list)
+{
+	sl::ConstIterator<DocBlock> it = list.getHead();
+	for (; it; it++)
+	{
+		if (it->m_blockKind == "ref")
+			addRef(static_cast<const DocRefBlock*>(*it)->m_handle);
+
+		addDocBlockList(it->m_childBlockList);
+	}
+}
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+void
+GlobalNamespace::buildUsedByIndex(Module* module)
+{
+	UsedByIndexer indexer(module);
+
+	sl::Iterator<Compound> compoundIt = module->m_compoundList.getHead();
+	for (; compoundIt; compoundIt++)
+	{
+		if (compoundIt->m_compoundKind == CompoundKind_Group) // doxy groups contain duplicated definitions of members
+			continue;
+
+		sl::Iterator<Member> memberIt = compoundIt->m_memberList.getHead();
+		for (; memberIt; memberIt++)
+			if (!(memberIt->m_flags & MemberFlag_Duplicate))
+				indexer.addUser(*memberIt);
+	}
 }
 
 void
@@ -1449,10 +2103,7 @@ GlobalNamespace::getGroupNamespace(
 }
 
 Compound*
-GlobalNamespace::createMemberCompound(
-	Module* module,
-	Member* member
-	)
+GlobalNamespace::createMemberCompound(Member* member)
 {
 	Compound* compound = AXL_MEM_NEW(Compound);
 	compound->m_compoundKind = member->m_memberKind == MemberKind_Service ? CompoundKind_Service : CompoundKind_Interface;
@@ -1463,10 +2114,19 @@ GlobalNamespace::createMemberCompound(
 	sl::takeOver(&compound->m_detailedDescription, &member->m_detailedDescription);
 	compound->m_selfNamespace = AXL_MEM_NEW(Namespace);
 	compound->m_selfNamespace->m_compound = compound;
-	m_namespaceList.insertTail(compound->m_selfNamespace);
-	module->m_compoundList.insertTail(compound);
-
 	return compound;
 }
 
+void
+GlobalNamespace::addNewCompound(
+	Module* module,
+	Compound* compound
+	)
+{
+	if (compound->m_selfNamespace)
+		m_namespaceList.insertTail(compound->m_selfNamespace);
+
+	module->m_compoundList.insertTail(compound);
+}
+
 //..............................................................................
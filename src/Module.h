@@ -12,6 +12,7 @@
 #pragma once
 
 #include "DoxyXmlEnum.h"
+#include "DoxyXmlArchive.h"
 
 struct Namespace;
 struct Member;
@@ -20,9 +21,57 @@ struct Module;
 
 //..............................................................................
 
-sl::String
-createPath(
-	const sl::StringRef& name,
+// item paths are stored as (parent node, name) pairs so that all the members
+// of a deeply nested namespace share its prefix; flattened strings are only
+// produced when requested
+
+struct PathNode: sl::ListLink
+{
+	PathNode* m_parent;
+	sl::String m_name; // shares the buffer with the name of the item
+	size_t m_length;   // length of the flattened path
+
+	PathNode()
+	{
+		m_parent = NULL;
+		m_length = 0;
+	}
+
+	sl::String
+	getPath();
+
+	sl::String
+	getFileNamePath(); // '/' replaced with '_', operator signs trimmed
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+class PathTable
+{
+protected:
+	sl::List<PathNode> m_nodeList;
+
+public:
+	size_t
+	getCount()
+	{
+		return m_nodeList.getCount();
+	}
+
+	PathNode*
+	addNode(
+		PathNode* parent,
+		const sl::String& name
+		);
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+PathNode*
+preparePathNode(
+	PathTable* pathTable,
+	PathNode** node,
+	const sl::String& name,
 	Namespace* parentNamespace
 	);
 
@@ -35,10 +84,12 @@ struct RefText: sl::ListLink
 	sl::String m_id;
 	sl::String m_external;
 	sl::String m_tooltip;
+	size_t m_handle;
 
 	RefText()
 	{
 		m_refKind = RefKind_Undefined;
+		m_handle = -1;
 	}
 
 	void
@@ -61,6 +112,23 @@ struct LinkedText
 
 //..............................................................................
 
+// run-time class of a doc block (m_blockKind is the XML element name, and
+// several elements share a class)
+
+enum DocBlockClass
+{
+	DocBlockClass_Block,
+	DocBlockClass_Ref,
+	DocBlockClass_Anchor,
+	DocBlockClass_Image,
+	DocBlockClass_Ulink,
+	DocBlockClass_Heading,
+	DocBlockClass_Section,
+	DocBlockClass_SimpleSection,
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
 struct DocBlock: sl::ListLink
 {
 	sl::String m_blockKind;
@@ -72,6 +140,13 @@ struct DocBlock: sl::ListLink
 	{
 	}
 
+	virtual
+	DocBlockClass
+	getDocBlockClass()
+	{
+		return DocBlockClass_Block;
+	}
+
 	virtual
 	void
 	luaExport(lua::LuaState* luaState);
@@ -89,11 +164,20 @@ struct DocRefBlock: DocBlock
 	RefKind m_refKind;
 	sl::String m_id;
 	sl::String m_external;
+	size_t m_handle;
 
 	DocRefBlock()
 	{
 		m_refKind = RefKind_Undefined;
 		m_module = NULL;
+		m_handle = -1;
+	}
+
+	virtual
+	DocBlockClass
+	getDocBlockClass()
+	{
+		return DocBlockClass_Ref;
 	}
 
 	virtual
@@ -107,6 +191,13 @@ struct DocAnchorBlock: DocBlock
 {
 	sl::String m_id;
 
+	virtual
+	DocBlockClass
+	getDocBlockClass()
+	{
+		return DocBlockClass_Anchor;
+	}
+
 	virtual
 	void
 	luaExport(lua::LuaState* luaState);
@@ -123,6 +214,13 @@ struct DocImageBlock: DocBlock
 
 	DocImageBlock();
 
+	virtual
+	DocBlockClass
+	getDocBlockClass()
+	{
+		return DocBlockClass_Image;
+	}
+
 	virtual
 	void
 	luaExport(lua::LuaState* luaState);
@@ -134,6 +232,13 @@ struct DocUlinkBlock: DocBlock
 {
 	sl::String m_url;
 
+	virtual
+	DocBlockClass
+	getDocBlockClass()
+	{
+		return DocBlockClass_Ulink;
+	}
+
 	virtual
 	void
 	luaExport(lua::LuaState* luaState);
@@ -150,6 +255,13 @@ struct DocHeadingBlock: DocBlock
 		m_level = 0;
 	}
 
+	virtual
+	DocBlockClass
+	getDocBlockClass()
+	{
+		return DocBlockClass_Heading;
+	}
+
 	virtual
 	void
 	luaExport(lua::LuaState* luaState);
@@ -161,6 +273,13 @@ struct DocSectionBlock: DocBlock
 {
 	sl::String m_id;
 
+	virtual
+	DocBlockClass
+	getDocBlockClass()
+	{
+		return DocBlockClass_Section;
+	}
+
 	virtual
 	void
 	luaExport(lua::LuaState* luaState);
@@ -172,6 +291,13 @@ struct DocSimpleSectionBlock: DocBlock
 {
 	sl::String m_simpleSectionKind;
 
+	virtual
+	DocBlockClass
+	getDocBlockClass()
+	{
+		return DocBlockClass_SimpleSection;
+	}
+
 	virtual
 	void
 	luaExport(lua::LuaState* luaState);
@@ -179,18 +305,75 @@ struct DocSimpleSectionBlock: DocBlock
 
 //.............................................................................
 
+// where to re-read deferred descriptions from (one per compound definition)
+
+struct DescriptionSource: sl::ListLink
+{
+	Module* m_module;
+	Compound* m_compound;
+	DoxyXmlArchive* m_archive; // if non-NULL, m_filePath is inside the archive
+	sl::String m_filePath;
+
+	DescriptionSource()
+	{
+		m_module = NULL;
+		m_compound = NULL;
+		m_archive = NULL;
+	}
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
 struct Description
 {
 	sl::String m_title;
 	sl::List<DocBlock> m_docBlockList;
 
+	// deferred parsing: until loaded, only the byte range of the description
+	// element is known; the doc block tree is parsed on demand. m_source stays
+	// set after loading (streaming mode may unload and re-parse it later)
+
+	DescriptionSource* m_source;
+	size_t m_offset;
+	size_t m_length;
+	bool m_hasContent;
+	bool m_isLoaded;
+	sl::Array<size_t> m_refHandleArray; // <ref> targets inside the deferred range
+
+	Description()
+	{
+		m_source = NULL;
+		m_offset = 0;
+		m_length = 0;
+		m_hasContent = false;
+		m_isLoaded = false;
+	}
+
 	bool isEmpty()
 	{
-		return m_title.isEmpty() && m_docBlockList.isEmpty();
+		return isDeferred() ?
+			!m_hasContent :
+			m_title.isEmpty() && m_docBlockList.isEmpty();
+	}
+
+	// deferred and not parsed yet
+
+	bool
+	isDeferred() const
+	{
+		return m_source && !m_isLoaded;
 	}
 
+	bool
+	load();
+
 	void
 	luaExport(lua::LuaState* luaState);
+
+protected:
+	static
+	int
+	index_lua(lua_State* h);
 };
 
 //.............................................................................
@@ -240,6 +423,7 @@ struct EnumValue: sl::ListLink
 	ProtectionKind m_protectionKind;
 
 	sl::String m_id;
+	size_t m_handle;
 	sl::String m_name;
 	Member* m_parentEnum;
 	LinkedText m_initializer;
@@ -314,6 +498,7 @@ struct Member: sl::ListLink
 	uint_t m_flags;
 
 	sl::String m_id;
+	size_t m_handle;
 	LinkedText m_type;
 	sl::String m_name;
 	sl::String m_definition;
@@ -328,8 +513,9 @@ struct Member: sl::ListLink
 	sl::List<Param> m_templateParamList;
 	sl::List<Param> m_templateSpecParamList;
 	sl::List<EnumValue> m_enumValueList;
+	sl::Array<Member*> m_usedByArray; // members referencing this one in types or docs
 
-	sl::String m_path;
+	PathNode* m_pathNode;
 
 	Description m_briefDescription;
 	Description m_detailedDescription;
@@ -343,11 +529,10 @@ struct Member: sl::ListLink
 	void
 	luaExport(lua::LuaState* luaState);
 
-	void
-	preparePath()
+	PathNode*
+	preparePathNode(PathTable* pathTable)
 	{
-		if (m_path.isEmpty())
-			m_path = createPath(m_name, m_parentNamespace);
+		return ::preparePathNode(pathTable, &m_pathNode, m_name, m_parentNamespace);
 	}
 };
 
@@ -361,11 +546,13 @@ struct Ref: sl::ListLink
 	sl::String m_id;
 	sl::String m_importId;
 	sl::String m_text;
+	size_t m_handle;
 
 	Ref()
 	{
 		m_protectionKind = ProtectionKind_Undefined;
 		m_virtualKind = VirtualKind_Undefined;
+		m_handle = -1;
 	}
 
 	size_t
@@ -395,6 +582,7 @@ struct Compound: sl::ListLink
 	ProtectionKind m_protectionKind;
 
 	sl::String m_id;
+	size_t m_handle;
 	sl::String m_importId;
 	sl::String m_name;
 	sl::String m_title;
@@ -409,13 +597,15 @@ struct Compound: sl::ListLink
 	sl::List<Ref> m_innerRefList;
 
 	sl::Array<Compound*> m_baseTypeArray;
+	sl::Array<Compound*> m_baseTypeClosureArray; // all (transitive) bases, most remote first
 	sl::Array<Compound*> m_derivedTypeArray_doxy; // explicitly specified in doxy
 	sl::Array<Compound*> m_derivedTypeArray_auto; // auto-generated
 	sl::Array<ProtectionKind> m_baseTypeProtectionArray;
 
 	sl::Array<Compound*> m_subPageArray;
+	sl::Array<Member*> m_usedByArray; // members referencing this compound in types or docs
 
-	sl::String m_path;
+	PathNode* m_pathNode;
 
 	bool m_isFinal     : 1;
 	bool m_isSealed    : 1;
@@ -425,11 +615,15 @@ struct Compound: sl::ListLink
 
 	bool m_hasGlobalNamespace : 1;
 
+	bool m_isBaseTypeClosureReady   : 1;
+	bool m_isBaseTypeClosurePending : 1;
+
 	Description m_briefDescription;
 	Description m_detailedDescription;
 	Location m_location;
 
 	size_t m_cacheIdx;
+	size_t m_mark; // for one-pass algorithms over compound graphs
 
 	Compound();
 
@@ -454,26 +648,152 @@ struct Compound: sl::ListLink
 	createTemplateSpecParam(const sl::StringRef& name);
 
 	void
-	preparePath()
+	prepareBaseTypeClosure(size_t* mark);
+
+	PathNode*
+	preparePathNode(PathTable* pathTable)
 	{
-		if (m_path.isEmpty())
-			m_path = createPath(m_name, m_parentNamespace);
+		return ::preparePathNode(pathTable, &m_pathNode, m_name, m_parentNamespace);
 	}
 };
 
 //..............................................................................
 
+struct StringInternStats
+{
+	size_t m_requestCount;
+	size_t m_hitCount;
+	size_t m_savedSize;
+
+	StringInternStats()
+	{
+		m_requestCount = 0;
+		m_hitCount = 0;
+		m_savedSize = 0;
+	}
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+// every doxy id (whether defined or only referenced) is mapped to a dense
+// integer handle once, at parse time; after that, cross-references are
+// resolved by indexing into the handle table -- no more string hashing
+
+struct HandleEntry
+{
+	Compound* m_compound;
+	Member* m_member;
+	EnumValue* m_enumValue;
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+// in streaming mode, descriptions parsed while rendering a file are dropped
+// (and re-armed for deferred parsing) as soon as the file is done
+
+#define DOXYREST_LOADED_DESCRIPTIONS_KEY "doxyrest.LoadedDescriptions" // Lua registry
+
 struct Module
 {
+	sl::StringHashTable<bool> m_internTable; // keys share buffers with interned strings
+	StringInternStats m_internStats;
+
 	sl::String m_version;
 	sl::List<Compound> m_compoundList;
 	sl::Array<Compound*> m_namespaceArray;
 	sl::Array<Compound*> m_groupArray;
 	sl::Array<Compound*> m_pageArray;
 	sl::Array<Compound*> m_exampleArray;
-	sl::StringHashTable<Compound*> m_compoundMap;
-	sl::StringHashTable<Member*> m_memberMap;
-	sl::StringHashTable<EnumValue*> m_enumValueMap;
+	sl::StringHashTable<size_t> m_handleMap;
+	sl::Array<HandleEntry> m_handleTable;
+	PathTable m_pathTable;
+
+	sl::List<DescriptionSource> m_descriptionSourceList;
+	sys::Lock m_deferredDescriptionLock; // guards descriptions & the cached file below
+	DescriptionSource* m_cachedDescriptionSource;
+	DoxyXmlArchiveFile m_cachedDescriptionFile;
+	size_t m_deferredDescriptionCount;
+	size_t m_loadedDescriptionCount;
+	size_t m_skippedXmlSize;
+	size_t m_groupMemberRefCount; // group members parsed as id references only
+
+	bool m_isStreaming;
+	sl::Array<Description*> m_loadedDescriptionArray;
+	size_t m_unloadedDescriptionCount;
+	size_t m_maxLoadedDescriptionCount; // at once
+
+	Module()
+	{
+		m_skippedXmlSize = 0;
+		m_groupMemberRefCount = 0;
+		m_cachedDescriptionSource = NULL;
+		m_deferredDescriptionCount = 0;
+		m_loadedDescriptionCount = 0;
+		m_isStreaming = false;
+		m_unloadedDescriptionCount = 0;
+		m_maxLoadedDescriptionCount = 0;
+	}
+
+	const sl::String&
+	intern(const sl::StringRef& string);
+
+	// compounds and members remember their slots in g_exportCache of the Lua
+	// state they were exported to; must be cleared before exporting to another
+
+	void
+	clearExportCache();
+
+	// frees the doc block trees of all descriptions parsed since the last call
+	// (streaming mode only)
+
+	void
+	unloadDescriptions();
+
+	// pre-sizes the id tables (e.g. with the id count from IndexSkeleton), so
+	// they don't have to grow while compound files are being parsed
+
+	void
+	reserveHandles(size_t count)
+	{
+		m_handleTable.reserve(count);
+		m_handleMap.setBucketCount(count);
+	}
+
+	size_t
+	getHandle(const sl::StringRef& id);
+
+	// -1 if the id is unknown (doesn't register it)
+
+	size_t
+	findHandle(const sl::StringRef& id)
+	{
+		size_t value = m_handleMap.findValue(id, 0);
+		return value ? value - 1 : -1; // see getHandle
+	}
+
+	HandleEntry*
+	getHandleEntry(size_t handle)
+	{
+		return handle < m_handleTable.getCount() ? m_handleTable.p() + handle : NULL;
+	}
+
+	Compound*
+	getCompound(size_t handle)
+	{
+		return handle < m_handleTable.getCount() ? m_handleTable.cp()[handle].m_compound : NULL;
+	}
+
+	Member*
+	getMember(size_t handle)
+	{
+		return handle < m_handleTable.getCount() ? m_handleTable.cp()[handle].m_member : NULL;
+	}
+
+	EnumValue*
+	getEnumValue(size_t handle)
+	{
+		return handle < m_handleTable.getCount() ? m_handleTable.cp()[handle].m_enumValue : NULL;
+	}
 };
 
 //..............................................................................
@@ -543,8 +863,60 @@ struct Namespace:
 
 // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
+// while namespaces are being built (possibly, in parallel), updates of the
+// data shared between compounds are collected in buffers and applied later
+// in a deterministic order
+
+struct GroupEntry
+{
+	Compound* m_groupCompound;
+	Compound* m_compound;
+	Member* m_member;
+	Compound* m_thisCompound;
+};
+
+struct DerivedTypeEntry
+{
+	Compound* m_baseCompound;
+	Compound* m_derivedCompound;
+};
+
+struct NamespaceBuildBuffer
+{
+	sl::Array<GroupEntry> m_groupEntryArray;
+	sl::Array<DerivedTypeEntry> m_derivedTypeArray;
+	sl::Array<Compound*> m_newCompoundArray; // member compounds & template/imported bases
+	sl::String m_warnings;
+	sl::String m_errorString;
+
+	void
+	addGroupEntry(
+		Compound* groupCompound,
+		Compound* compound
+		)
+	{
+		GroupEntry entry = { groupCompound, compound, NULL, NULL };
+		m_groupEntryArray.append(entry);
+	}
+
+	void
+	addGroupEntry(
+		Compound* groupCompound,
+		Member* member,
+		Compound* thisCompound
+		)
+	{
+		GroupEntry entry = { groupCompound, NULL, member, thisCompound };
+		m_groupEntryArray.append(entry);
+	}
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
 class GlobalNamespace: public NamespaceContents
 {
+	friend class NamespaceBuildThread;
+
 protected:
 	sl::List<Namespace> m_namespaceList;
 	Compound* m_auxCompound; // for title/brief/detailed
@@ -555,6 +927,18 @@ public:
 		m_auxCompound = NULL;
 	}
 
+	const sl::List<Namespace>&
+	getNamespaceList()
+	{
+		return m_namespaceList;
+	}
+
+	Compound*
+	getAuxCompound()
+	{
+		return m_auxCompound;
+	}
+
 	void
 	clear();
 
@@ -562,7 +946,8 @@ public:
 	build(
 		Module* module,
 		const sl::StringRef& globalGroupId,
-		const sl::StringRef& footnoteMemberPrefix
+		const sl::StringRef& footnoteMemberPrefix,
+		size_t threadCount = 1
 		);
 
 	void
@@ -576,10 +961,39 @@ protected:
 		);
 
 	Compound*
-	createMemberCompound(
+	createMemberCompound(Member* member);
+
+	void
+	addNewCompound(
+		Module* module,
+		Compound* compound
+		);
+
+	bool
+	buildNamespaces(Module* module);
+
+	bool
+	buildNamespacesParallel(
+		Module* module,
+		size_t threadCount
+		);
+
+	bool
+	buildNamespaceRange(
 		Module* module,
-		Member* member
+		size_t begin,
+		size_t end,
+		NamespaceBuildBuffer* buffer
 		);
+
+	void
+	applyNamespaceBuildBuffer(
+		Module* module,
+		NamespaceBuildBuffer* buffer
+		);
+
+	void
+	buildUsedByIndex(Module* module);
 };
 
 //..............................................................................
@@ -0,0 +1,240 @@
+//..............................................................................
+//
+//  This file is part of the Doxyrest toolkit.
+//
+//  Doxyrest is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/doxyrest/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "OutputSink.h"
+#include "DoxyXmlArchive.h"
+
+//..............................................................................
+
+bool
+DirOutputSink::writeFileImpl(
+	const sl::StringRef& filePath,
+	const void* p,
+	size_t size
+	)
+{
+	bool result;
+
+	sl::String dir = io::getDir(filePath);
+	if (dir != m_lastDir)
+	{
+		result = io::ensureDirExists(dir);
+		if (!result)
+			return false;
+
+		m_lastDir = dir;
+	}
+
+	if (m_isUnchangedSkipped && isFileUnchanged(filePath, p, size))
+	{
+		m_unchangedFileCount++;
+		return true;
+	}
+
+	io::File file;
+	result = file.open(filePath, io::FileFlag_Clear);
+	if (!result)
+		return false;
+
+	size_t writtenSize = file.write(p, size);
+	if (writtenSize != size)
+	{
+		err::setFormatStringError("error writing '%s'", filePath.sz());
+		return false;
+	}
+
+	return true;
+}
+
+bool
+DirOutputSink::isFileUnchanged(
+	const sl::StringRef& filePath,
+	const void* p,
+	size_t size
+	)
+{
+	io::File file;
+	bool result = file.open(filePath, io::FileFlag_ReadOnly);
+	if (!result || file.getSize() != size)
+		return false;
+
+	sl::Array<char> contents;
+	contents.setCount(size);
+	return
+		file.read(contents.p(), size) == size &&
+		memcmp(contents.cp(), p, size) == 0;
+}
+
+//..............................................................................
+
+sl::String
+RelativeOutputSink::getRelativePath(const sl::StringRef& filePath)
+{
+	sl::StringRef path = filePath.isPrefix(m_rootDir) ?
+		filePath.getSubString(m_rootDir.getLength()) :
+		filePath;
+
+	const char* p = path.cp();
+	const char* end = p + path.getLength();
+	while (p < end && (*p == '/' || *p == '\\'))
+		p++;
+
+	sl::String relativePath(p, end - p);
+
+	char* dst = relativePath.getBuffer();
+	size_t length = relativePath.getLength();
+	for (size_t i = 0; i < length; i++)
+		if (dst[i] == '\\') // archive paths are always forward-slash separated
+			dst[i] = '/';
+
+	return relativePath;
+}
+
+//..............................................................................
+
+static
+void
+setTarNumber(
+	char* p,
+	size_t length,
+	uint64_t value
+	)
+{
+	// zero-padded octal followed by a NUL
+
+	p[length - 1] = 0;
+
+	for (intptr_t i = length - 2; i >= 0; i--)
+	{
+		p[i] = '0' + (value & 7);
+		value >>= 3;
+	}
+}
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+bool
+TarOutputSink::open(const sl::StringRef& fileName)
+{
+	bool result = m_file.open(fileName, io::FileFlag_Clear);
+	if (!result)
+		return false;
+
+	m_fileName = fileName;
+	return true;
+}
+
+bool
+TarOutputSink::finalize()
+{
+	static const char zeroBlocks[TarDef_BlockSize * 2] = { 0 }; // end-of-archive marker
+
+	bool result = writeBlock(zeroBlocks, sizeof(zeroBlocks));
+	if (!result)
+		return false;
+
+	m_file.close();
+	return true;
+}
+
+bool
+TarOutputSink::writeFileImpl(
+	const sl::StringRef& filePath,
+	const void* p,
+	size_t size
+	)
+{
+	sl::String name = getRelativePath(filePath);
+
+	bool result = name.getLength() < TarDef_NameLength || // GNU long name for the rest
+		writeEntry('L', "././@LongLink", name.sz(), name.getLength() + 1);
+
+	return result && writeEntry('0', name, p, size);
+}
+
+bool
+TarOutputSink::writeEntry(
+	char type,
+	const sl::StringRef& name,
+	const void* p,
+	size_t size
+	)
+{
+	char hdr[TarDef_BlockSize] = { 0 };
+
+	memcpy(hdr + TarDef_NameOffset, name.cp(), AXL_MIN(name.getLength(), (size_t)TarDef_NameLength - 1));
+	memcpy(hdr + TarDef_ModeOffset, "0000644", TarDef_ModeLength);
+	setTarNumber(hdr + TarDef_SizeOffset, TarDef_SizeLength, size);
+	setTarNumber(hdr + TarDef_MtimeOffset, TarDef_MtimeLength, time(NULL));
+	memcpy(hdr + TarDef_MagicOffset, "ustar\0" "00", 8);
+	hdr[TarDef_TypeOffset] = type;
+
+	memset(hdr + TarDef_ChecksumOffset, ' ', TarDef_ChecksumLength);
+
+	uint64_t checksum = 0;
+	for (size_t i = 0; i < TarDef_BlockSize; i++)
+		checksum += (uchar_t)hdr[i];
+
+	setTarNumber(hdr + TarDef_ChecksumOffset, TarDef_ChecksumLength - 1, checksum);
+
+	bool result = writeBlock(hdr, sizeof(hdr)) && writeBlock(p, size);
+	if (!result)
+		return false;
+
+	static const char padding[TarDef_BlockSize] = { 0 };
+
+	size_t paddingSize = (TarDef_BlockSize - size % TarDef_BlockSize) % TarDef_BlockSize;
+	return writeBlock(padding, paddingSize);
+}
+
+bool
+TarOutputSink::writeBlock(
+	const void* p,
+	size_t size
+	)
+{
+	size_t writtenSize = m_file.write(p, size);
+	if (writtenSize != size)
+	{
+		err::setFormatStringError("error writing '%s'", m_fileName.sz());
+		return false;
+	}
+
+	return true;
+}
+
+//..............................................................................
+
+bool
+MemoryOutputSink::writeFileImpl(
+	const sl::StringRef& filePath,
+	const void* p,
+	size_t size
+	)
+{
+	sl::String fileName = getRelativePath(filePath);
+
+	sl::StringHashTableIterator<MemoryOutputFile*> it = m_fileMap.visit(fileName);
+	MemoryOutputFile* file = it->m_value;
+	if (!file)
+	{
+		file = AXL_MEM_NEW(MemoryOutputFile);
+		file->m_fileName = fileName;
+		m_fileList.insertTail(file);
+		it->m_value = file;
+	}
+
+	file->m_contents.copy((const char*)p, size); // re-generated files replace the old contents
+	return true;
+}
+
+//..............................................................................
@@ -0,0 +1,313 @@
+//..............................................................................
+//
+//  This file is part of the Doxyrest toolkit.
+//
+//  Doxyrest is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/doxyrest/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+//..............................................................................
+
+enum OutputSinkKind
+{
+	OutputSinkKind_Dir,
+	OutputSinkKind_Tar,
+	OutputSinkKind_Memory,
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+// destination of all the files generated by frames; paths passed to writeFile
+// are full paths (i.e. based on the directory of the master output file)
+
+class OutputSink
+{
+protected:
+	OutputSinkKind m_kind;
+	size_t m_fileCount;
+	uint64_t m_totalSize;
+
+public:
+	OutputSink(OutputSinkKind kind)
+	{
+		m_kind = kind;
+		m_fileCount = 0;
+		m_totalSize = 0;
+	}
+
+	virtual
+	~OutputSink()
+	{
+	}
+
+	OutputSinkKind
+	getKind()
+	{
+		return m_kind;
+	}
+
+	size_t
+	getFileCount()
+	{
+		return m_fileCount;
+	}
+
+	uint64_t
+	getTotalSize()
+	{
+		return m_totalSize;
+	}
+
+	// the counters are per render
+
+	virtual
+	void
+	resetCounters()
+	{
+		m_fileCount = 0;
+		m_totalSize = 0;
+	}
+
+	bool
+	writeFile(
+		const sl::StringRef& filePath,
+		const void* p,
+		size_t size
+		)
+	{
+		m_fileCount++;
+		m_totalSize += size;
+		return writeFileImpl(filePath, p, size);
+	}
+
+	bool
+	writeFile(
+		const sl::StringRef& filePath,
+		const sl::StringRef& contents
+		)
+	{
+		return writeFile(filePath, contents.cp(), contents.getLength());
+	}
+
+	virtual
+	bool
+	finalize()
+	{
+		return true;
+	}
+
+protected:
+	virtual
+	bool
+	writeFileImpl(
+		const sl::StringRef& filePath,
+		const void* p,
+		size_t size
+		) = 0;
+};
+
+//..............................................................................
+
+// every file goes to the file system (the default)
+
+class DirOutputSink: public OutputSink
+{
+protected:
+	sl::String m_lastDir; // avoid re-checking the same directory for every file
+	bool m_isUnchangedSkipped;
+	size_t m_unchangedFileCount;
+
+public:
+	DirOutputSink():
+		OutputSink(OutputSinkKind_Dir)
+	{
+		m_isUnchangedSkipped = false;
+		m_unchangedFileCount = 0;
+	}
+
+	// when set, files with the same contents are not re-written (so their
+	// modification time is preserved and incremental Sphinx builds only
+	// process what has actually changed)
+
+	void
+	setUnchangedSkipped(bool isSkipped)
+	{
+		m_isUnchangedSkipped = isSkipped;
+	}
+
+	size_t
+	getUnchangedFileCount()
+	{
+		return m_unchangedFileCount;
+	}
+
+	virtual
+	void
+	resetCounters()
+	{
+		OutputSink::resetCounters();
+		m_unchangedFileCount = 0;
+		m_lastDir.clear(); // could have been removed in between
+	}
+
+protected:
+	virtual
+	bool
+	writeFileImpl(
+		const sl::StringRef& filePath,
+		const void* p,
+		size_t size
+		);
+
+	static
+	bool
+	isFileUnchanged(
+		const sl::StringRef& filePath,
+		const void* p,
+		size_t size
+		);
+};
+
+//..............................................................................
+
+// base for sinks which store files under paths relative to the output root
+
+class RelativeOutputSink: public OutputSink
+{
+protected:
+	sl::String m_rootDir;
+
+public:
+	RelativeOutputSink(OutputSinkKind kind):
+		OutputSink(kind)
+	{
+	}
+
+	const sl::String&
+	getRootDir()
+	{
+		return m_rootDir;
+	}
+
+	void
+	setRootDir(const sl::StringRef& dir)
+	{
+		m_rootDir = dir;
+	}
+
+	sl::String
+	getRelativePath(const sl::StringRef& filePath);
+};
+
+//..............................................................................
+
+// all files are packed into a single uncompressed tar archive
+
+class TarOutputSink: public RelativeOutputSink
+{
+protected:
+	sl::String m_fileName;
+	io::File m_file;
+
+public:
+	TarOutputSink():
+		RelativeOutputSink(OutputSinkKind_Tar)
+	{
+	}
+
+	const sl::String&
+	getFileName()
+	{
+		return m_fileName;
+	}
+
+	bool
+	open(const sl::StringRef& fileName);
+
+	virtual
+	bool
+	finalize();
+
+protected:
+	virtual
+	bool
+	writeFileImpl(
+		const sl::StringRef& filePath,
+		const void* p,
+		size_t size
+		);
+
+	bool
+	writeEntry(
+		char type,
+		const sl::StringRef& name,
+		const void* p,
+		size_t size
+		);
+
+	bool
+	writeBlock(
+		const void* p,
+		size_t size
+		);
+};
+
+//..............................................................................
+
+struct MemoryOutputFile: sl::ListLink
+{
+	sl::String m_fileName; // relative to the output root
+	sl::Array<char> m_contents;
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+// files are kept in memory -- to be consumed by the host application
+
+class MemoryOutputSink: public RelativeOutputSink
+{
+protected:
+	sl::List<MemoryOutputFile> m_fileList;
+	sl::StringHashTable<MemoryOutputFile*> m_fileMap;
+
+public:
+	MemoryOutputSink():
+		RelativeOutputSink(OutputSinkKind_Memory)
+	{
+	}
+
+	const sl::List<MemoryOutputFile>&
+	getFileList()
+	{
+		return m_fileList;
+	}
+
+	const MemoryOutputFile*
+	findFile(const sl::StringRef& fileName)
+	{
+		return m_fileMap.findValue(fileName, NULL);
+	}
+
+	void
+	clear()
+	{
+		m_fileList.clear();
+		m_fileMap.clear();
+	}
+
+protected:
+	virtual
+	bool
+	writeFileImpl(
+		const sl::StringRef& filePath,
+		const void* p,
+		size_t size
+		);
+};
+
+//..............................................................................
@@ -0,0 +1,498 @@
+//..............................................................................
+//
+//  This file is part of the Doxyrest toolkit.
+//
+//  Doxyrest is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/doxyrest/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "SearchIndex.h"
+#include "OutputSink.h"
+#include "Module.h"
+
+//..............................................................................
+
+sl::String
+getQualifiedName(
+	PathNode* pathNode,
+	const sl::StringRef& separator
+	)
+{
+	sl::Array<PathNode*> nodeArray;
+	for (PathNode* node = pathNode; node; node = node->m_parent)
+		if (!node->m_name.isEmpty())
+			nodeArray.append(node);
+
+	sl::String name;
+
+	size_t count = nodeArray.getCount();
+	for (intptr_t i = count - 1; i >= 0; i--)
+	{
+		name += nodeArray[i]->m_name;
+		if (i)
+			name += separator;
+	}
+
+	return name;
+}
+
+static
+bool
+isSpaceSuffix(const sl::String& string)
+{
+	size_t length = string.getLength();
+	return length && string.cp()[length - 1] == ' ';
+}
+
+static
+void
+appendPlainText(
+	sl::String* string,
+	const sl::List<DocBlock>& list,
+	size_t maxLength
+	)
+{
+	sl::ConstIterator<DocBlock> it = list.getHead();
+	for (; it && string->getLength() < maxLength; it++)
+	{
+		const char* p = it->m_text.cp();
+		const char* end = p + it->m_text.getLength();
+
+		for (; p < end && string->getLength() < maxLength; p++)
+		{
+			char c = *p;
+			if (!isspace((uchar_t)c))
+				*string += c;
+			else if (!string->isEmpty() && !isSpaceSuffix(*string))
+				*string += ' ';
+		}
+
+		appendPlainText(string, it->m_childBlockList, maxLength);
+
+		if (!string->isEmpty() && !isSpaceSuffix(*string))
+			*string += ' ';
+	}
+}
+
+sl::String
+getPlainText(
+	Description* description,
+	size_t maxLength
+	)
+{
+	if (description->isEmpty())
+		return sl::String();
+
+	bool result = description->load(); // no-op unless deferred
+	if (!result)
+		return sl::String();
+
+	sl::String string;
+	appendPlainText(&string, description->m_docBlockList, maxLength);
+
+	const char* p = string.cp();
+	size_t length = string.getLength();
+
+	if (length >= maxLength) // don't leave half of a UTF-8 sequence
+	{
+		while (length && ((uchar_t)p[length - 1] & 0xc0) == 0x80)
+			length--;
+
+		if (length && (uchar_t)p[length - 1] >= 0xc0)
+			length--;
+	}
+
+	while (length && p[length - 1] == ' ')
+		length--;
+
+	return string.getSubString(0, length);
+}
+
+void
+appendJsonString(
+	sl::String* string,
+	const sl::StringRef& value
+	)
+{
+	*string += '"';
+
+	const char* p = value.cp();
+	const char* end = p + value.getLength();
+	const char* chunk = p;
+
+	for (; p < end; p++)
+	{
+		uchar_t c = *p;
+		if (c >= 0x20 && c != '"' && c != '\\')
+			continue;
+
+		string->append(chunk, p - chunk);
+		chunk = p + 1;
+
+		switch (c)
+		{
+		case '"':
+			*string += "\\\"";
+			break;
+
+		case '\\':
+			*string += "\\\\";
+			break;
+
+		case '\n':
+			*string += "\\n";
+			break;
+
+		case '\t':
+			*string += "\\t";
+			break;
+
+		default:
+			string->appendFormat("\\u%04x", c);
+		}
+	}
+
+	string->append(chunk, end - chunk);
+	*string += '"';
+}
+
+//..............................................................................
+
+inline
+bool
+isSearchIndexEntryLess(
+	const SearchIndexEntry* entry1,
+	const SearchIndexEntry* entry2
+	)
+{
+	int cmp = strcmp(entry1->m_key.sz(), entry2->m_key.sz());
+	return cmp ? cmp < 0 : strcmp(entry1->m_qualifiedName.sz(), entry2->m_qualifiedName.sz()) < 0;
+}
+
+static
+sl::String
+getSearchKey(const sl::StringRef& name)
+{
+	static const char hexDigitTable[] = "0123456789abcdef"; // shard file names must not differ in case only
+
+	sl::String key;
+	key.reserve(name.getLength());
+
+	const char* p = name.cp();
+	const char* end = p + name.getLength();
+	for (; p < end; p++)
+	{
+		uchar_t c = *p;
+		if (c >= 0x80 || c == '%')
+		{
+			char buffer[3] = { '%', hexDigitTable[c >> 4], hexDigitTable[c & 0x0f] };
+			key.append(buffer, 3);
+		}
+		else
+		{
+			char lower = c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+			key.append(&lower, 1);
+		}
+	}
+
+	return key;
+}
+
+static
+sl::String
+getShardName(
+	const sl::StringRef& key,
+	size_t prefixLength = SearchIndex_PrefixLength
+	)
+{
+	char buffer[SearchIndex_PrefixLength];
+	size_t length = AXL_MIN(key.getLength(), prefixLength);
+
+	for (size_t i = 0; i < length; i++)
+	{
+		uchar_t c = key.cp()[i];
+		buffer[i] = isalnum(c) ? c : '_';
+	}
+
+	return sl::String(buffer, length);
+}
+
+static
+void
+appendShardEntry(
+	sl::String* shard,
+	const SearchIndexEntry* entry
+	)
+{
+	*shard += shard->isEmpty() ? "[[" : ",\n[";
+	appendJsonString(shard, entry->m_key);
+	*shard += ',';
+	appendJsonString(shard, entry->m_qualifiedName);
+	*shard += ',';
+	appendJsonString(shard, entry->m_kind);
+	*shard += ',';
+	appendJsonString(shard, entry->m_page);
+	*shard += ',';
+	appendJsonString(shard, entry->m_id);
+	*shard += ',';
+	appendJsonString(shard, entry->m_brief);
+	*shard += ']';
+}
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+void
+SearchIndex::clear()
+{
+	m_entryList.clear();
+	m_pageMap.clear();
+	m_shardCount = 0;
+	m_totalSize = 0;
+}
+
+void
+SearchIndex::addPage(
+	const sl::StringRef& id,
+	const sl::StringRef& fileName
+	)
+{
+	sl::StringHashTableIterator<sl::String> it = m_pageMap.visit(id);
+	if (!it->m_value.isEmpty())
+		return;
+
+	size_t dot = fileName.reverseFind('.');
+	it->m_value = dot != -1 ? fileName.getSubString(0, dot) : fileName;
+}
+
+void
+SearchIndex::addEntry(
+	const sl::StringRef& name,
+	const sl::StringRef& qualifiedName,
+	const char* kind,
+	const sl::StringRef& id,
+	const sl::StringRef& pageId,
+	const sl::StringRef& pageId2,
+	Description* briefDescription
+	)
+{
+	if (name.isEmpty())
+		return;
+
+	SearchIndexEntry* entry = AXL_MEM_NEW(SearchIndexEntry);
+	entry->m_key = getSearchKey(name);
+	entry->m_qualifiedName = qualifiedName;
+	entry->m_kind = kind;
+	entry->m_id = id;
+	entry->m_brief = getPlainText(briefDescription, SearchIndex_MaxBriefLength);
+
+	// the page of the item itself, or the page of its container
+
+	entry->m_page = m_pageMap.findValue(id, sl::String());
+	if (entry->m_page.isEmpty() && !pageId.isEmpty())
+		entry->m_page = m_pageMap.findValue(pageId, sl::String());
+
+	if (entry->m_page.isEmpty() && !pageId2.isEmpty())
+		entry->m_page = m_pageMap.findValue(pageId2, sl::String());
+
+	m_entryList.insertTail(entry);
+}
+
+void
+SearchIndex::build(Module* module)
+{
+	sl::Iterator<Compound> compoundIt = module->m_compoundList.getHead();
+	for (; compoundIt; compoundIt++)
+	{
+		Compound* compound = *compoundIt;
+		if (compound->m_isDuplicate || compound->m_compoundKind == CompoundKind_Dir)
+			continue;
+
+		bool isTitled =
+			compound->m_compoundKind == CompoundKind_Group ||
+			compound->m_compoundKind == CompoundKind_Page;
+
+		sl::String qualifiedName = isTitled && !compound->m_title.isEmpty() ?
+			compound->m_title :
+			compound->m_pathNode ?
+				getQualifiedName(compound->m_pathNode) :
+				compound->m_name;
+
+		size_t delim = qualifiedName.reverseFind(':');
+		sl::StringRef name = !isTitled && delim != -1 ?
+			qualifiedName.getSubString(delim + 1) :
+			qualifiedName;
+
+		addEntry(
+			name,
+			qualifiedName,
+			getCompoundKindString(compound->m_compoundKind),
+			compound->m_id,
+			sl::StringRef(),
+			sl::StringRef(),
+			&compound->m_briefDescription
+			);
+
+		if (compound->m_compoundKind == CompoundKind_Group) // doxy groups contain duplicated definitions of members
+			continue;
+
+		sl::Iterator<Member> memberIt = compound->m_memberList.getHead();
+		for (; memberIt; memberIt++)
+		{
+			Member* member = *memberIt;
+			if (member->m_flags & MemberFlag_Duplicate)
+				continue;
+
+			sl::String memberQualifiedName = member->m_pathNode ?
+				getQualifiedName(member->m_pathNode) :
+				member->m_name;
+
+			sl::StringRef parentId = member->m_parentCompound ? member->m_parentCompound->m_id : sl::StringRef();
+			sl::StringRef groupId = member->m_groupCompound ? member->m_groupCompound->m_id : sl::StringRef();
+
+			addEntry(
+				member->m_name,
+				memberQualifiedName,
+				getMemberKindString(member->m_memberKind),
+				member->m_id,
+				parentId,
+				groupId,
+				&member->m_briefDescription
+				);
+
+			sl::Iterator<EnumValue> enumValueIt = member->m_enumValueList.getHead();
+			for (; enumValueIt; enumValueIt++)
+			{
+				if (enumValueIt->m_isDuplicate)
+					continue;
+
+				addEntry(
+					enumValueIt->m_name,
+					memberQualifiedName + "::" + enumValueIt->m_name,
+					getMemberKindString(MemberKind_EnumValue),
+					enumValueIt->m_id,
+					member->m_id,
+					parentId,
+					&enumValueIt->m_briefDescription
+					);
+			}
+		}
+	}
+}
+
+bool
+SearchIndex::write(
+	OutputSink* sink,
+	const sl::StringRef& dir
+	)
+{
+	size_t count = m_entryList.getCount();
+
+	sl::Array<SearchIndexEntry*> sortArray;
+	sortArray.setCount(count);
+
+	sl::Iterator<SearchIndexEntry> it = m_entryList.getHead();
+	for (size_t i = 0; it; it++, i++)
+		sortArray[i] = *it;
+
+	std::sort(sortArray.p(), sortArray.p() + count, isSearchIndexEntryLess);
+
+	// entries keep their relative (sorted) order within each shard
+
+	sl::StringHashTable<sl::String> shardMap;
+	sl::BoxList<sl::String> shardNameList;
+	sl::StringHashTable<size_t> shortShardCountMap;
+	sl::StringHashTable<sl::String> shortShardMap;
+	sl::BoxList<sl::String> shortShardNameList;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		SearchIndexEntry* entry = sortArray[i];
+		sl::String shardName = getShardName(entry->m_key);
+
+		sl::StringHashTableIterator<sl::String> shardIt = shardMap.visit(shardName);
+		if (shardIt->m_value.isEmpty())
+			shardNameList.insertTail(shardName);
+
+		appendShardEntry(&shardIt->m_value, entry);
+
+		for (size_t j = 1; j < SearchIndex_PrefixLength && j <= shardName.getLength(); j++)
+		{
+			sl::String shortShardName = getShardName(entry->m_key, j);
+
+			sl::StringHashTableIterator<size_t> countIt = shortShardCountMap.visit(shortShardName);
+			if (countIt->m_value >= SearchIndex_ShortShardLimit)
+				continue;
+
+			if (!countIt->m_value)
+				shortShardNameList.insertTail(shortShardName);
+
+			countIt->m_value++;
+			appendShardEntry(&shortShardMap.visit(shortShardName)->m_value, entry);
+		}
+	}
+
+	m_shardCount = 0;
+	m_totalSize = 0;
+
+	sl::String manifest;
+	manifest.format(
+		"{\"version\":%d,\"prefixLength\":%d,\"shortShardLimit\":%d,\"entryCount\":%d,\"shards\":[",
+		SearchIndexVersion_Current,
+		SearchIndex_PrefixLength,
+		SearchIndex_ShortShardLimit,
+		(int)count
+		);
+
+	bool result = writeShards(sink, dir, &manifest, &shardMap, shardNameList, ".json");
+	if (!result)
+		return false;
+
+	manifest += "],\"shortShards\":[";
+
+	result = writeShards(sink, dir, &manifest, &shortShardMap, shortShardNameList, ".short.json");
+	if (!result)
+		return false;
+
+	manifest += "]}\n";
+	m_totalSize += manifest.getLength();
+
+	return sink->writeFile(io::concatFilePath(dir, DOXYREST_SEARCH_INDEX_MANIFEST), manifest);
+}
+
+bool
+SearchIndex::writeShards(
+	OutputSink* sink,
+	const sl::StringRef& dir,
+	sl::String* manifest,
+	sl::StringHashTable<sl::String>* shardMap,
+	const sl::BoxList<sl::String>& shardNameList,
+	const sl::StringRef& suffix
+	)
+{
+	size_t i = 0;
+	sl::ConstBoxIterator<sl::String> nameIt = shardNameList.getHead();
+	for (; nameIt; nameIt++, i++)
+	{
+		sl::String* shard = &shardMap->visit(*nameIt)->m_value;
+		*shard += "]\n";
+
+		bool result = sink->writeFile(io::concatFilePath(dir, *nameIt + suffix), *shard);
+		if (!result)
+			return false;
+
+		if (i)
+			*manifest += ',';
+
+		appendJsonString(manifest, *nameIt);
+		m_shardCount++;
+		m_totalSize += shard->getLength();
+	}
+
+	return true;
+}
+
+//..............................................................................
@@ -0,0 +1,165 @@
+//..............................................................................
+//
+//  This file is part of the Doxyrest toolkit.
+//
+//  Doxyrest is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/doxyrest/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+class OutputSink;
+struct Module;
+struct PathNode;
+struct Description;
+
+//..............................................................................
+
+// prebuilt symbol index for client-side search (see sphinx/js/doxyrest-search.js)
+//
+//   <dir>/index.json  -- {"version":2,"prefixLength":2,"shortShardLimit":N,
+//                         "entryCount":N,"shards":[...],"shortShards":[...]}
+//   <dir>/<shard>.json -- [[key,qualifiedName,kind,page,id,brief],...]
+//   <dir>/<short-shard>.short.json -- same
+//
+// key is the unqualified name in plain ASCII: A-Z are lower-cased, while '%'
+// and all the bytes of non-ASCII UTF-8 characters are percent-encoded (%xx),
+// so the client can reproduce keys (and their order) exactly; entries of a
+// shard share the first prefixLength characters of the key (non-alphanumerics
+// become '_') and are sorted by key, so a client only fetches one small shard
+// per query and finds the prefix range with a binary search; the target anchor
+// is doxid-<id> on the page (a generated file name without the extension).
+//
+// queries shorter than prefixLength are answered by short shards: the first
+// shortShardLimit entries (in key order) of all the shards starting with the
+// short prefix
+
+#define DOXYREST_SEARCH_INDEX_MANIFEST "index.json"
+
+enum
+{
+	SearchIndexVersion_Current   = 2,
+	SearchIndex_PrefixLength     = 2,
+	SearchIndex_ShortShardLimit  = 100,
+	SearchIndex_MaxBriefLength   = 160,
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+struct SearchIndexEntry: sl::ListLink
+{
+	sl::String m_key;
+	sl::String m_qualifiedName;
+	const char* m_kind;
+	sl::String m_page;
+	sl::String m_id;
+	sl::String m_brief;
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+class SearchIndex
+{
+protected:
+	sl::List<SearchIndexEntry> m_entryList;
+	sl::StringHashTable<sl::String> m_pageMap; // doxy id -> generated file
+	size_t m_shardCount;
+	uint64_t m_totalSize;
+
+public:
+	SearchIndex()
+	{
+		m_shardCount = 0;
+		m_totalSize = 0;
+	}
+
+	size_t
+	getEntryCount()
+	{
+		return m_entryList.getCount();
+	}
+
+	size_t
+	getShardCount()
+	{
+		return m_shardCount;
+	}
+
+	uint64_t
+	getTotalSize()
+	{
+		return m_totalSize;
+	}
+
+	void
+	clear();
+
+	// remembers where an item was rendered (the first file wins)
+
+	void
+	addPage(
+		const sl::StringRef& id,
+		const sl::StringRef& fileName
+		);
+
+	// collects entries for all compounds, members and enum values of a built
+	// model in one pass
+
+	void
+	build(Module* module);
+
+	bool
+	write(
+		OutputSink* sink,
+		const sl::StringRef& dir // full path
+		);
+
+protected:
+	void
+	addEntry(
+		const sl::StringRef& name,
+		const sl::StringRef& qualifiedName,
+		const char* kind,
+		const sl::StringRef& id,
+		const sl::StringRef& pageId,
+		const sl::StringRef& pageId2,
+		Description* briefDescription
+		);
+
+	// writes the shards and appends their names to the manifest
+
+	bool
+	writeShards(
+		OutputSink* sink,
+		const sl::StringRef& dir,
+		sl::String* manifest,
+		sl::StringHashTable<sl::String>* shardMap,
+		const sl::BoxList<sl::String>& shardNameList,
+		const sl::StringRef& suffix
+		);
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+sl::String
+getQualifiedName(
+	PathNode* pathNode,
+	const sl::StringRef& separator = "::"
+	);
+
+sl::String
+getPlainText(
+	Description* description,
+	size_t maxLength
+	);
+
+void
+appendJsonString(
+	sl::String* string,
+	const sl::StringRef& value
+	);
+
+//..............................................................................
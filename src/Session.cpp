@@ -0,0 +1,341 @@
+//..............................................................................
+//
+//  This file is part of the Doxyrest toolkit.
+//
+//  Doxyrest is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/doxyrest/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "Session.h"
+#include "DoxyXmlParser.h"
+#include "Module.h"
+#include "IndexSkeleton.h"
+
+//..............................................................................
+
+class RenderThread: public sys::ThreadImpl<RenderThread>
+{
+public:
+	Generator* m_generator;
+	bool m_result;
+	sl::String m_errorString;
+
+public:
+	void
+	threadFunc()
+	{
+		m_result = m_generator->generate();
+		if (!m_result)
+			m_errorString = err::getLastErrorDescription(); // errors are thread-local
+	}
+};
+
+//..............................................................................
+
+Session::~Session()
+{
+	clearModel();
+
+	size_t count = m_generatorArray.getCount();
+	for (size_t i = 1; i < count; i++)
+		AXL_MEM_DELETE(m_generatorArray[i]);
+}
+
+void
+Session::initialize()
+{
+	g::getModule()->setTag("doxyrest");
+	xml::registerExpatErrorProvider();
+	lex::registerParseErrorProvider();
+}
+
+void
+Session::clearModel()
+{
+	// the namespace tree points into the module
+
+	if (m_globalNamespace)
+	{
+		AXL_MEM_DELETE(m_globalNamespace);
+		m_globalNamespace = NULL;
+	}
+
+	if (m_module)
+	{
+		AXL_MEM_DELETE(m_module);
+		m_module = NULL;
+	}
+
+	m_archive.close();
+}
+
+bool
+Session::configure(const CmdLine* cmdLine)
+{
+	m_isMemoryStatsEnabled = (cmdLine->m_flags & CmdLineFlag_Stats) != 0;
+
+	sl::ConstBoxIterator<sl::String> it = cmdLine->m_configFileNameList.getHead();
+	bool result = m_generator.create(cmdLine, it ? *it : sl::StringRef());
+	if (!result)
+		return false;
+
+	if (it)
+		for (it++; it; it++)
+		{
+			result = addConfiguration(cmdLine, *it);
+			if (!result)
+				return false;
+		}
+
+	return true;
+}
+
+bool
+Session::addConfiguration(
+	const CmdLine* cmdLine,
+	const sl::StringRef& configFileName
+	)
+{
+	static const char* modelSettingTable[] =
+	{
+		"INPUT_FILE",
+		"GLOBAL_AUX_COMPOUND_ID",
+		"FOOTNOTE_MEMBER_PREFIX",
+	};
+
+	Generator* generator = AXL_MEM_NEW(Generator);
+	m_generatorArray.append(generator); // deleted in the destructor
+
+	bool result = generator->create(cmdLine, configFileName);
+	if (!result)
+		return false;
+
+	for (size_t i = 0; i < countof(modelSettingTable); i++)
+	{
+		const char* name = modelSettingTable[i];
+		if (generator->getConfigValue(name) != m_generator.getConfigValue(name))
+		{
+			err::setFormatStringError(
+				"'%s': %s differs from the first configuration (the model is shared)",
+				configFileName.sz(),
+				name
+				);
+
+			return false;
+		}
+	}
+
+	sl::String outputFilePath = io::getFullFilePath(generator->getOutputFileName());
+	size_t count = m_generatorArray.getCount() - 1;
+	for (size_t i = 0; i < count; i++)
+		if (io::getFullFilePath(m_generatorArray[i]->getOutputFileName()) == outputFilePath)
+		{
+			err::setFormatStringError(
+				"'%s': output file '%s' is already used by another configuration",
+				configFileName.sz(),
+				generator->getOutputFileName().sz()
+				);
+
+			return false;
+		}
+
+	return true;
+}
+
+bool
+Session::loadModel(
+	const sl::StringRef& inputFileName,
+	size_t threadCount
+	)
+{
+	bool result;
+
+	clearModel();
+
+	m_module = AXL_MEM_NEW(Module);
+	m_globalNamespace = AXL_MEM_NEW(GlobalNamespace);
+
+	sl::String globalAuxCompoundId = m_generator.getConfigValue("GLOBAL_AUX_COMPOUND_ID");
+	sl::String footnoteMemberPrefix = m_generator.getConfigValue("FOOTNOTE_MEMBER_PREFIX");
+	sl::String xmlInputMode = m_generator.getConfigValue("XML_INPUT_MODE");
+	sl::String xmlBlockSizeString = m_generator.getConfigValue("XML_BLOCK_SIZE");
+
+	DoxyXmlParser parser;
+	parser.setFootnoteMemberPrefix(footnoteMemberPrefix);
+
+	if (xmlInputMode.isEmpty() || xmlInputMode == "mmap")
+	{
+		parser.setFlags(parser.getFlags() | DoxyXmlParserFlag_Mmap);
+	}
+	else if (xmlInputMode != "read")
+	{
+		err::setFormatStringError("invalid XML_INPUT_MODE: '%s' (expected \"mmap\" or \"read\")", xmlInputMode.sz());
+		return false;
+	}
+
+	// streaming builds on deferred descriptions: the model itself is just a
+	// skeleton, and documentation is parsed (and freed) file by file
+
+	bool isStreaming = m_generator.getConfigBoolean("XML_STREAMING");
+	if (isStreaming && m_generatorArray.getCount() > 1)
+	{
+		err::setError("XML_STREAMING can't be used with multiple configurations");
+		return false;
+	}
+
+	m_module->m_isStreaming = isStreaming;
+
+	if (isStreaming || m_generator.getConfigBoolean("XML_DEFER_DESCRIPTIONS"))
+		parser.setFlags(parser.getFlags() | DoxyXmlParserFlag_DeferDescriptions);
+
+	size_t xmlBlockSize = !xmlBlockSizeString.isEmpty() ?
+		strtoul(xmlBlockSizeString.sz(), NULL, 0) :
+		DoxyXmlParser_DefaultBlockSize;
+
+	if (!xmlBlockSize)
+		xmlBlockSize = DoxyXmlParser_DefaultBlockSize;
+
+	// optionally, a quick pass over index.xml tells how many ids to expect
+
+	bool isPresizeHandles = m_generator.getConfigBoolean("XML_PRESIZE_HANDLES");
+	IndexSkeleton skeleton;
+
+	DoxyXmlArchiveKind archiveKind = getDoxyXmlArchiveKind(inputFileName);
+	if (archiveKind != DoxyXmlArchiveKind_Undefined)
+	{
+		result = m_archive.open(inputFileName);
+		if (!result)
+			return false;
+
+		sl::String indexPath = m_archive.findIndexFile();
+		if (indexPath.isEmpty())
+		{
+			err::setFormatStringError("no index.xml in '%s'", inputFileName.sz());
+			return false;
+		}
+
+		if (isPresizeHandles && skeleton.load(&m_archive, indexPath))
+			m_module->reserveHandles(skeleton.getIdCount());
+
+		skeleton.clear();
+
+		result = parser.parseArchiveFile(m_module, &m_archive, DoxyXmlFileKind_Index, indexPath, xmlBlockSize);
+	}
+	else
+	{
+		if (isPresizeHandles && skeleton.load(inputFileName))
+			m_module->reserveHandles(skeleton.getIdCount());
+
+		skeleton.clear();
+
+		result = parser.parseFile(m_module, inputFileName, xmlBlockSize);
+	}
+	if (!result)
+		return false;
+
+	if (m_isMemoryStatsEnabled)
+		m_parseMemoryStats.collect(m_module, NULL);
+
+	result = m_globalNamespace->build(m_module, globalAuxCompoundId, footnoteMemberPrefix, threadCount);
+	if (!result)
+		return false;
+
+	if (m_isMemoryStatsEnabled)
+		m_buildMemoryStats.collect(m_module, m_globalNamespace);
+
+	size_t count = m_generatorArray.getCount();
+	for (size_t i = 0; i < count; i++)
+	{
+		if (i)
+			m_module->clearExportCache();
+
+		result = m_generatorArray[i]->luaExport(m_module, m_globalNamespace);
+		if (!result)
+			return false;
+	}
+
+	return true;
+}
+
+bool
+Session::render(OutputSink* sink)
+{
+	if (!m_module)
+	{
+		err::setError("no model loaded");
+		return false;
+	}
+
+	if (m_generatorArray.getCount() > 1)
+	{
+		if (sink)
+		{
+			err::setError("a custom output sink can't be shared by multiple configurations");
+			return false;
+		}
+
+		return renderParallel();
+	}
+
+	if (!sink)
+		return m_generator.generate();
+
+	OutputSink* prevSink = m_generator.getOutputSink();
+	m_generator.setOutputSink(sink);
+	bool result = m_generator.generate();
+	m_generator.setOutputSink(prevSink);
+	return result;
+}
+
+bool
+Session::renderParallel()
+{
+	// generators share the model; each one has its own Lua state and output
+	// sink. the only part of the model which changes during rendering is
+	// deferred descriptions -- those are parsed under a lock (see
+	// Description::load) and never add handles, so the handle table read by
+	// getCompound/getMember/getHandleEntry stays as it was after build()
+
+	size_t count = m_generatorArray.getCount();
+
+	sl::Array<RenderThread*> threadArray;
+	threadArray.setCount(count);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		RenderThread* thread = AXL_MEM_NEW(RenderThread);
+		thread->m_generator = m_generatorArray[i];
+		thread->m_result = false;
+		threadArray[i] = thread;
+	}
+
+	for (size_t i = 1; i < count; i++)
+		threadArray[i]->start();
+
+	threadArray[0]->threadFunc(); // the calling thread takes the first configuration
+
+	for (size_t i = 1; i < count; i++)
+		threadArray[i]->waitAndClose();
+
+	bool result = true;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		RenderThread* thread = threadArray[i];
+		if (result && !thread->m_result)
+		{
+			err::setFormatStringError("%s", thread->m_errorString.sz());
+			result = false;
+		}
+
+		AXL_MEM_DELETE(thread);
+	}
+
+	return result;
+}
+
+//..............................................................................
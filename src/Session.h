@@ -0,0 +1,165 @@
+//..............................................................................
+//
+//  This file is part of the Doxyrest toolkit.
+//
+//  Doxyrest is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/doxyrest/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+#include "Generator.h"
+#include "DoxyXmlArchive.h"
+#include "MemoryStats.h"
+
+struct Module;
+class GlobalNamespace;
+
+//..............................................................................
+
+// in-process entry point of libdoxyrest: configure once (this is where the Lua
+// state is created), load a model, then render it as many times as needed --
+// into the configured output or into any OutputSink (e.g. MemoryOutputSink)
+//
+//   Session::initialize(); // once per process
+//
+//   Session session;
+//   session.configure(&cmdLine);
+//   session.loadModel("xml/index.xml");
+//   session.render(&memoryOutputSink);
+//
+// several configurations (each with its own generator and Lua state) can share
+// a single model -- it's parsed and built once, then rendered by all the
+// generators in parallel
+
+class Session
+{
+protected:
+	Generator m_generator;
+	sl::Array<Generator*> m_generatorArray; // [0] is m_generator
+	DoxyXmlArchive m_archive; // must outlive the model (deferred descriptions)
+	Module* m_module;
+	GlobalNamespace* m_globalNamespace;
+
+	bool m_isMemoryStatsEnabled; // --stats
+	ModelMemoryStats m_parseMemoryStats;
+	ModelMemoryStats m_buildMemoryStats;
+
+public:
+	Session()
+	{
+		m_module = NULL;
+		m_globalNamespace = NULL;
+		m_isMemoryStatsEnabled = false;
+		m_generatorArray.append(&m_generator);
+	}
+
+	~Session();
+
+	// registers error providers used by doxyrest; call once per process
+
+	static
+	void
+	initialize();
+
+	size_t
+	getGeneratorCount()
+	{
+		return m_generatorArray.getCount();
+	}
+
+	Generator*
+	getGenerator(size_t i = 0)
+	{
+		return m_generatorArray[i];
+	}
+
+	Module*
+	getModule()
+	{
+		return m_module;
+	}
+
+	GlobalNamespace*
+	getGlobalNamespace()
+	{
+		return m_globalNamespace;
+	}
+
+	bool
+	isModelLoaded()
+	{
+		return m_module != NULL;
+	}
+
+	// per-type memory of the model right after parsing and after the namespace
+	// tree is built (only collected with --stats)
+
+	ModelMemoryStats*
+	getParseMemoryStats()
+	{
+		return &m_parseMemoryStats;
+	}
+
+	ModelMemoryStats*
+	getBuildMemoryStats()
+	{
+		return &m_buildMemoryStats;
+	}
+
+	// creates a generator for each of the configuration files on the command
+	// line (or a single one, if there are none)
+
+	bool
+	configure(const CmdLine* cmdLine);
+
+	// adds a generator for one more configuration; settings affecting the model
+	// (INPUT_FILE, GLOBAL_AUX_COMPOUND_ID, etc) must match the first one
+
+	bool
+	addConfiguration(
+		const CmdLine* cmdLine,
+		const sl::StringRef& configFileName
+		);
+
+	// overrides a Lua configuration variable (e.g. per-request settings) in
+	// all configurations; affects the next loadModel/render
+
+	void
+	define(
+		const sl::StringRef& name,
+		const sl::StringRef& value
+		)
+	{
+		size_t count = m_generatorArray.getCount();
+		for (size_t i = 0; i < count; i++)
+			m_generatorArray[i]->setConfigValue(name, value);
+	}
+
+	// parses Doxygen XML (index.xml or an archive), builds the namespace tree
+	// and exports the model to Lua; replaces the previously loaded model
+
+	bool
+	loadModel(
+		const sl::StringRef& inputFileName,
+		size_t threadCount = 1
+		);
+
+	void
+	clearModel();
+
+	// renders the loaded model; if sink is NULL, the configured output is used
+	// (a custom sink can only be used with a single configuration)
+
+	bool
+	render(OutputSink* sink = NULL);
+
+protected:
+	bool
+	renderParallel();
+};
+
+//..............................................................................
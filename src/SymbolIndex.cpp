@@ -0,0 +1,703 @@
+//..............................................................................
+//
+//  This file is part of the Doxyrest toolkit.
+//
+//  Doxyrest is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/doxyrest/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "SymbolIndex.h"
+#include "IndexSkeleton.h"
+
+#if (_AXL_OS_POSIX)
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <fcntl.h>
+#	include <unistd.h>
+#endif
+
+//..............................................................................
+
+static
+bool
+getFileStamp(
+	const sl::StringRef& fileName,
+	uint64_t* size,
+	uint64_t* time
+	)
+{
+#if (_AXL_OS_POSIX)
+	struct stat st;
+	int result = ::stat(fileName.sz(), &st);
+	if (result == -1)
+	{
+		err::setLastSystemError();
+		return false;
+	}
+
+	*size = st.st_size;
+	*time = st.st_mtime;
+#else
+	io::File file;
+	bool result = file.open(fileName, io::FileFlag_ReadOnly);
+	if (!result)
+		return false;
+
+	*size = file.getSize();
+	*time = 0; // the size alone has to do
+#endif
+
+	return true;
+}
+
+// byte-wise, like CrefDb
+
+static
+int
+compareBytes(
+	const sl::StringRef& string1,
+	const sl::StringRef& string2
+	)
+{
+	size_t length1 = string1.getLength();
+	size_t length2 = string2.getLength();
+	int cmp = memcmp(string1.cp(), string2.cp(), AXL_MIN(length1, length2));
+	return cmp ? cmp : length1 < length2 ? -1 : length1 > length2 ? 1 : 0;
+}
+
+static
+bool
+isPrefix(
+	const sl::StringRef& string,
+	const sl::StringRef& prefix
+	)
+{
+	return
+		string.getLength() >= prefix.getLength() &&
+		memcmp(string.cp(), prefix.cp(), prefix.getLength()) == 0;
+}
+
+static
+void
+addResult(
+	sl::Array<size_t>* resultArray,
+	size_t idx
+	)
+{
+	size_t count = resultArray->getCount();
+	for (size_t i = 0; i < count; i++)
+		if ((*resultArray)[i] == idx)
+			return;
+
+	resultArray->append(idx);
+}
+
+sl::String
+getDefaultSymbolIndexFileName(const sl::StringRef& inputFileName)
+{
+	return inputFileName + ".symbols";
+}
+
+//..............................................................................
+
+struct SymbolIndexBuildEntry
+{
+	sl::String m_name;
+	sl::StringRef m_id;
+	const char* m_kind;
+	size_t m_compoundIdx;
+	bool m_isMember;
+};
+
+class SymbolIndexBuildNameLess
+{
+protected:
+	const SymbolIndexBuildEntry* m_entryTable;
+
+public:
+	SymbolIndexBuildNameLess(const SymbolIndexBuildEntry* entryTable)
+	{
+		m_entryTable = entryTable;
+	}
+
+	bool
+	operator () (
+		size_t idx1,
+		size_t idx2
+		) const
+	{
+		int cmp = compareBytes(m_entryTable[idx1].m_name, m_entryTable[idx2].m_name);
+		return cmp ? cmp < 0 : compareBytes(m_entryTable[idx1].m_id, m_entryTable[idx2].m_id) < 0;
+	}
+};
+
+class SymbolIndexBuildIdLess
+{
+protected:
+	const SymbolIndexBuildEntry* m_entryTable;
+	const size_t* m_orderTable; // new index -> build index
+
+public:
+	SymbolIndexBuildIdLess(
+		const SymbolIndexBuildEntry* entryTable,
+		const size_t* orderTable
+		)
+	{
+		m_entryTable = entryTable;
+		m_orderTable = orderTable;
+	}
+
+	bool
+	operator () (
+		uint32_t idx1,
+		uint32_t idx2
+		) const
+	{
+		return compareBytes(
+			m_entryTable[m_orderTable[idx1]].m_id,
+			m_entryTable[m_orderTable[idx2]].m_id
+			) < 0;
+	}
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+struct SymbolFuzzyMatch
+{
+	size_t m_idx;
+	int m_score;
+};
+
+inline
+bool
+isSymbolFuzzyMatchBetter(
+	const SymbolFuzzyMatch& match1,
+	const SymbolFuzzyMatch& match2
+	)
+{
+	return match1.m_score != match2.m_score ?
+		match1.m_score > match2.m_score :
+		match1.m_idx < match2.m_idx; // entries are sorted by name
+}
+
+// pattern characters must occur in the name in order (case-insensitive);
+// consecutive characters and word starts (after '::', '_' or a lower-upper
+// case transition) score higher, and so do shorter names; -1 if no match
+
+static
+int
+getFuzzyScore(
+	const sl::StringRef& name,
+	const sl::StringRef& pattern // lower-case
+	)
+{
+	const char* p = name.cp();
+	size_t length = name.getLength();
+	size_t patternLength = pattern.getLength();
+
+	int score = 0;
+	bool isPrevMatch = false;
+	size_t j = 0;
+
+	for (size_t i = 0; i < length && j < patternLength; i++)
+	{
+		uchar_t c = p[i];
+		if (tolower(c) != (uchar_t)pattern.cp()[j])
+		{
+			isPrevMatch = false;
+			continue;
+		}
+
+		score += 1;
+
+		if (isPrevMatch)
+			score += 4;
+
+		uchar_t prev = i ? p[i - 1] : ':';
+		if (prev == ':' || prev == '_' || (islower(prev) && isupper(c)))
+			score += 3;
+
+		isPrevMatch = true;
+		j++;
+	}
+
+	if (j < patternLength)
+		return -1;
+
+	return score * 16 - (int)AXL_MIN(length, (size_t)255);
+}
+
+//..............................................................................
+
+bool
+SymbolIndex::open(
+	const sl::StringRef& inputFileName,
+	const sl::StringRef& cacheFileName
+	)
+{
+	uint64_t sourceSize;
+	uint64_t sourceTime;
+
+	bool result = getFileStamp(inputFileName, &sourceSize, &sourceTime);
+	if (!result)
+		return false;
+
+	result = load(cacheFileName);
+	if (result &&
+		m_hdr->m_sourceSize == sourceSize &&
+		m_hdr->m_sourceTime == sourceTime)
+	{
+		m_isRebuilt = false;
+		return true;
+	}
+
+	IndexSkeleton skeleton;
+	result = skeleton.loadInput(inputFileName);
+	if (!result)
+		return false;
+
+	result = build(&skeleton, sourceSize, sourceTime);
+	if (!result)
+		return false;
+
+	m_isRebuilt = true;
+
+	// a read-only input directory is not fatal -- the index just isn't cached
+
+	result = save(cacheFileName);
+	if (!result)
+		fprintf(stderr, "warning: %s\n", err::getLastErrorDescription().sz());
+
+	return true;
+}
+
+void
+SymbolIndex::close()
+{
+#if (_AXL_OS_POSIX)
+	if (m_isMapped)
+		::munmap((void*)m_data, m_size);
+#endif
+
+	m_buffer.clear();
+	m_data = NULL;
+	m_size = 0;
+	m_isMapped = false;
+	m_hdr = NULL;
+	m_entryTable = NULL;
+	m_idOrderTable = NULL;
+}
+
+#if (_AXL_OS_POSIX)
+
+bool
+SymbolIndex::load(const sl::StringRef& fileName)
+{
+	close();
+
+	int fd = ::open(fileName.sz(), O_RDONLY);
+	if (fd == -1)
+	{
+		err::setLastSystemError();
+		return false;
+	}
+
+	struct stat st;
+	int result = ::fstat(fd, &st);
+	if (result == -1 || !st.st_size) // an empty file is not an index; attachData will say so
+	{
+		::close(fd);
+
+		if (result == -1)
+		{
+			err::setLastSystemError();
+			return false;
+		}
+
+		return attachData(fileName);
+	}
+
+	void* view = ::mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd); // the mapping holds its own reference
+
+	if (view == MAP_FAILED)
+	{
+		err::setLastSystemError();
+		return false;
+	}
+
+	m_data = (const char*)view;
+	m_size = st.st_size;
+	m_isMapped = true;
+
+	bool isValid = attachData(fileName);
+	if (!isValid)
+	{
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+#else
+
+bool
+SymbolIndex::load(const sl::StringRef& fileName)
+{
+	close();
+
+	io::File file;
+	bool result = file.open(fileName, io::FileFlag_ReadOnly);
+	if (!result)
+		return false;
+
+	size_t size = (size_t)file.getSize();
+	m_buffer.setCount(size);
+	if (file.read(m_buffer.p(), size) != size)
+	{
+		err::setFormatStringError("error reading '%s'", fileName.sz());
+		return false;
+	}
+
+	m_data = m_buffer.cp();
+	m_size = size;
+
+	result = attachData(fileName);
+	if (!result)
+	{
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+#endif
+
+bool
+SymbolIndex::attachData(const sl::StringRef& fileName)
+{
+	size_t size = m_size;
+	const SymbolIndexHdr* hdr = (const SymbolIndexHdr*)m_data;
+
+	if (size < sizeof(SymbolIndexHdr) ||
+		memcmp(hdr->m_signature, DOXYREST_SYMBOL_INDEX_SIGNATURE, sizeof(hdr->m_signature)) != 0 ||
+		hdr->m_version != SymbolIndexVersion_Current)
+	{
+		err::setFormatStringError("'%s' is not a doxyrest symbol index", fileName.sz());
+		return false;
+	}
+
+	size_t count = hdr->m_entryCount;
+	size_t poolOffset = sizeof(SymbolIndexHdr) + count * (sizeof(SymbolIndexEntry) + sizeof(uint32_t));
+	if (count > size || poolOffset > size)
+	{
+		err::setFormatStringError("symbol index '%s' is corrupted", fileName.sz());
+		return false;
+	}
+
+	const SymbolIndexEntry* entryTable = (const SymbolIndexEntry*)(hdr + 1);
+	const uint32_t* idOrderTable = (const uint32_t*)(entryTable + count);
+
+	// validate once, so lookups don't have to
+
+	for (size_t i = 0; i < count; i++)
+	{
+		const SymbolIndexEntry* entry = &entryTable[i];
+		if ((uint64_t)entry->m_nameOffset + entry->m_nameLength > size ||
+			(uint64_t)entry->m_idOffset + entry->m_idLength > size ||
+			(uint64_t)entry->m_kindOffset + entry->m_kindLength > size ||
+			(entry->m_compoundIdx != (uint32_t)-1 && entry->m_compoundIdx >= count) ||
+			idOrderTable[i] >= count)
+		{
+			err::setFormatStringError("symbol index '%s' is corrupted", fileName.sz());
+			return false;
+		}
+	}
+
+	m_hdr = hdr;
+	m_entryTable = entryTable;
+	m_idOrderTable = idOrderTable;
+	return true;
+}
+
+bool
+SymbolIndex::save(const sl::StringRef& fileName)
+{
+	io::File file;
+	bool result = file.open(fileName, io::FileFlag_Clear);
+	if (!result)
+		return false;
+
+	size_t size = file.write(m_data, m_size);
+	if (size != m_size)
+	{
+		err::setFormatStringError("error writing '%s'", fileName.sz());
+		return false;
+	}
+
+	return true;
+}
+
+bool
+SymbolIndex::build(
+	IndexSkeleton* skeleton,
+	uint64_t sourceSize,
+	uint64_t sourceTime
+	)
+{
+	close();
+
+	const sl::List<IndexCompound>& compoundList = skeleton->getCompoundList();
+	const sl::List<IndexMember>& memberList = skeleton->getMemberList();
+	size_t compoundCount = compoundList.getCount();
+	size_t count = compoundCount + memberList.getCount();
+
+	sl::Array<SymbolIndexBuildEntry> buildArray;
+	buildArray.setCount(count);
+
+	sl::StringHashTable<size_t> compoundIdxMap;
+
+	sl::ConstIterator<IndexCompound> compoundIt = compoundList.getHead();
+	for (size_t i = 0; compoundIt; compoundIt++, i++)
+		compoundIdxMap.visit(compoundIt->m_id)->m_value = i;
+
+	compoundIt = compoundList.getHead();
+	for (size_t i = 0; compoundIt; compoundIt++, i++)
+	{
+		SymbolIndexBuildEntry* entry = &buildArray[i];
+		entry->m_name = compoundIt->m_name;
+		entry->m_id = compoundIt->m_id;
+		entry->m_kind = getCompoundKindString(compoundIt->m_compoundKind);
+		entry->m_compoundIdx = compoundIt->m_parent ? compoundIdxMap.findValue(compoundIt->m_parent->m_id, -1) : -1;
+		entry->m_isMember = false;
+	}
+
+	sl::ConstIterator<IndexMember> memberIt = memberList.getHead();
+	for (size_t i = compoundCount; memberIt; memberIt++, i++)
+	{
+		SymbolIndexBuildEntry* entry = &buildArray[i];
+		entry->m_name = memberIt->getQualifiedName();
+		entry->m_id = memberIt->m_id;
+		entry->m_kind = getMemberKindString(memberIt->m_memberKind);
+		entry->m_compoundIdx = memberIt->m_compound ? compoundIdxMap.findValue(memberIt->m_compound->m_id, -1) : -1;
+		entry->m_isMember = true;
+	}
+
+	// order by name, then remap compound indices to the new order
+
+	sl::Array<size_t> orderArray; // new index -> build index
+	sl::Array<size_t> newIdxArray; // build index -> new index
+	orderArray.setCount(count);
+	newIdxArray.setCount(count);
+
+	for (size_t i = 0; i < count; i++)
+		orderArray[i] = i;
+
+	std::sort(orderArray.p(), orderArray.p() + count, SymbolIndexBuildNameLess(buildArray.cp()));
+
+	for (size_t i = 0; i < count; i++)
+		newIdxArray[orderArray[i]] = i;
+
+	size_t idOrderOffset = sizeof(SymbolIndexHdr) + count * sizeof(SymbolIndexEntry);
+	size_t poolOffset = idOrderOffset + count * sizeof(uint32_t);
+
+	m_buffer.setCount(poolOffset);
+
+	sl::StringHashTable<size_t> kindOffsetMap; // kinds are few, store each once
+
+	for (size_t i = 0; i < count; i++)
+	{
+		const SymbolIndexBuildEntry* buildEntry = &buildArray[orderArray[i]];
+
+		SymbolIndexEntry entry;
+		entry.m_nameOffset = (uint32_t)m_buffer.getCount();
+		entry.m_nameLength = (uint32_t)buildEntry->m_name.getLength();
+		m_buffer.append(buildEntry->m_name.cp(), buildEntry->m_name.getLength());
+
+		entry.m_idOffset = (uint32_t)m_buffer.getCount();
+		entry.m_idLength = (uint32_t)buildEntry->m_id.getLength();
+		m_buffer.append(buildEntry->m_id.cp(), buildEntry->m_id.getLength());
+
+		size_t kindLength = strlen(buildEntry->m_kind);
+		sl::StringHashTableIterator<size_t> kindIt = kindOffsetMap.visit(buildEntry->m_kind);
+		if (!kindIt->m_value)
+		{
+			kindIt->m_value = m_buffer.getCount();
+			m_buffer.append(buildEntry->m_kind, kindLength);
+		}
+
+		entry.m_kindOffset = (uint32_t)kindIt->m_value;
+		entry.m_kindLength = (uint32_t)kindLength;
+		entry.m_compoundIdx = buildEntry->m_compoundIdx != -1 ? (uint32_t)newIdxArray[buildEntry->m_compoundIdx] : (uint32_t)-1;
+		entry.m_isMember = buildEntry->m_isMember;
+
+		// buffer may have been reallocated by now, so re-fetch the entry table
+
+		SymbolIndexEntry* entryTable = (SymbolIndexEntry*)(m_buffer.p() + sizeof(SymbolIndexHdr));
+		entryTable[i] = entry;
+	}
+
+	if (m_buffer.getCount() > UINT32_MAX)
+	{
+		err::setError("symbol index is too big");
+		return false;
+	}
+
+	uint32_t* idOrderTable = (uint32_t*)(m_buffer.p() + idOrderOffset);
+	for (size_t i = 0; i < count; i++)
+		idOrderTable[i] = (uint32_t)i;
+
+	std::sort(idOrderTable, idOrderTable + count, SymbolIndexBuildIdLess(buildArray.cp(), orderArray.cp()));
+
+	SymbolIndexHdr* hdr = (SymbolIndexHdr*)m_buffer.p();
+	memcpy(hdr->m_signature, DOXYREST_SYMBOL_INDEX_SIGNATURE, sizeof(hdr->m_signature));
+	hdr->m_version = SymbolIndexVersion_Current;
+	hdr->m_entryCount = (uint32_t)count;
+	hdr->m_sourceSize = sourceSize;
+	hdr->m_sourceTime = sourceTime;
+
+	m_data = m_buffer.cp();
+	m_size = m_buffer.getCount();
+	m_hdr = hdr;
+	m_entryTable = (const SymbolIndexEntry*)(hdr + 1);
+	m_idOrderTable = idOrderTable;
+	return true;
+}
+
+size_t
+SymbolIndex::findNameLowerBound(const sl::StringRef& name)
+{
+	size_t lo = 0;
+	size_t hi = m_hdr->m_entryCount;
+
+	while (lo < hi)
+	{
+		size_t mid = (lo + hi) / 2;
+		if (compareBytes(getName(&m_entryTable[mid]), name) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+size_t
+SymbolIndex::findIdLowerBound(const sl::StringRef& id)
+{
+	size_t lo = 0;
+	size_t hi = m_hdr->m_entryCount;
+
+	while (lo < hi)
+	{
+		size_t mid = (lo + hi) / 2;
+		if (compareBytes(getId(&m_entryTable[m_idOrderTable[mid]]), id) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+void
+SymbolIndex::find(
+	sl::Array<size_t>* resultArray,
+	const sl::StringRef& pattern,
+	SymbolMatchKind matchKind,
+	size_t maxCount
+	)
+{
+	if (!m_hdr || pattern.isEmpty())
+		return;
+
+	if (matchKind == SymbolMatchKind_Fuzzy)
+		findFuzzy(resultArray, pattern, maxCount);
+	else
+		findPrefix(resultArray, pattern, matchKind == SymbolMatchKind_Exact, maxCount);
+}
+
+// qualified names first, then ids
+
+void
+SymbolIndex::findPrefix(
+	sl::Array<size_t>* resultArray,
+	const sl::StringRef& prefix,
+	bool isExact,
+	size_t maxCount
+	)
+{
+	size_t count = m_hdr->m_entryCount;
+
+	size_t i = findNameLowerBound(prefix);
+	for (; i < count && resultArray->getCount() < maxCount; i++)
+	{
+		sl::StringRef name = getName(&m_entryTable[i]);
+		if (isExact ? compareBytes(name, prefix) != 0 : !isPrefix(name, prefix))
+			break;
+
+		addResult(resultArray, i);
+	}
+
+	i = findIdLowerBound(prefix);
+	for (; i < count && resultArray->getCount() < maxCount; i++)
+	{
+		size_t idx = m_idOrderTable[i];
+		sl::StringRef id = getId(&m_entryTable[idx]);
+		if (isExact ? compareBytes(id, prefix) != 0 : !isPrefix(id, prefix))
+			break;
+
+		addResult(resultArray, idx);
+	}
+}
+
+void
+SymbolIndex::findFuzzy(
+	sl::Array<size_t>* resultArray,
+	const sl::StringRef& pattern,
+	size_t maxCount
+	)
+{
+	size_t patternLength = pattern.getLength();
+
+	sl::String lowerPattern;
+	char* p = lowerPattern.createBuffer(patternLength);
+	for (size_t i = 0; i < patternLength; i++)
+		p[i] = tolower((uchar_t)pattern.cp()[i]);
+
+	sl::Array<SymbolFuzzyMatch> matchArray;
+
+	size_t count = m_hdr->m_entryCount;
+	for (size_t i = 0; i < count; i++)
+	{
+		int score = getFuzzyScore(getName(&m_entryTable[i]), lowerPattern);
+		if (score < 0)
+			continue;
+
+		SymbolFuzzyMatch match;
+		match.m_idx = i;
+		match.m_score = score;
+		matchArray.append(match);
+	}
+
+	size_t matchCount = matchArray.getCount();
+	size_t resultCount = AXL_MIN(matchCount, maxCount);
+
+	std::partial_sort(
+		matchArray.p(),
+		matchArray.p() + resultCount,
+		matchArray.p() + matchCount,
+		isSymbolFuzzyMatchBetter
+		);
+
+	for (size_t i = 0; i < resultCount; i++)
+		resultArray->append(matchArray[i].m_idx);
+}
+
+//..............................................................................
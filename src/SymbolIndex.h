@@ -0,0 +1,227 @@
+//..............................................................................
+//
+//  This file is part of the Doxyrest toolkit.
+//
+//  Doxyrest is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/doxyrest/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+class IndexSkeleton;
+
+//..............................................................................
+
+// on-disk symbol index used by 'doxyrest query' (all integers are in the host
+// byte order -- the index is a local cache; on a machine with another byte
+// order the version check fails and the index is simply rebuilt):
+//
+//   SymbolIndexHdr
+//   SymbolIndexEntry[m_entryCount] -- sorted by qualified name (byte-wise)
+//   uint32_t[m_entryCount]         -- entry indices sorted by id (byte-wise)
+//   string pool                    -- names, ids, kinds, not null-terminated
+//
+// the size and the modification time of the source XML (index.xml or an
+// archive) are recorded, so a stale index is rebuilt automatically
+
+#define DOXYREST_SYMBOL_INDEX_SIGNATURE "DXRSYMIX"
+
+enum
+{
+	SymbolIndexVersion_Current = 1,
+};
+
+struct SymbolIndexHdr
+{
+	char m_signature[8];
+	uint32_t m_version;
+	uint32_t m_entryCount;
+	uint64_t m_sourceSize;
+	uint64_t m_sourceTime;
+};
+
+struct SymbolIndexEntry
+{
+	uint32_t m_nameOffset;
+	uint32_t m_nameLength;
+	uint32_t m_idOffset;
+	uint32_t m_idLength;
+	uint32_t m_kindOffset;
+	uint32_t m_kindLength;
+	uint32_t m_compoundIdx; // the compound documenting this item; -1 if none
+	uint32_t m_isMember;
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+enum SymbolMatchKind
+{
+	SymbolMatchKind_Exact,
+	SymbolMatchKind_Prefix,
+	SymbolMatchKind_Fuzzy,
+};
+
+inline
+const char*
+getSymbolMatchKindString(SymbolMatchKind matchKind)
+{
+	const char* stringTable[] =
+	{
+		"exact",  // SymbolMatchKind_Exact
+		"prefix", // SymbolMatchKind_Prefix
+		"fuzzy",  // SymbolMatchKind_Fuzzy
+	};
+
+	return (size_t)matchKind < countof(stringTable) ?
+		stringTable[matchKind] :
+		"<undefined>";
+}
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+class SymbolIndex
+{
+protected:
+	sl::Array<char> m_buffer; // a freshly built index (or a loaded one where mapping is not available)
+	const char* m_data;       // either m_buffer or a read-only file mapping
+	size_t m_size;
+	bool m_isMapped;
+	const SymbolIndexHdr* m_hdr;
+	const SymbolIndexEntry* m_entryTable;
+	const uint32_t* m_idOrderTable;
+	bool m_isRebuilt;
+
+public:
+	SymbolIndex()
+	{
+		m_data = NULL;
+		m_size = 0;
+		m_isMapped = false;
+		m_hdr = NULL;
+		m_entryTable = NULL;
+		m_idOrderTable = NULL;
+		m_isRebuilt = false;
+	}
+
+	~SymbolIndex()
+	{
+		close();
+	}
+
+	size_t
+	getEntryCount()
+	{
+		return m_hdr ? m_hdr->m_entryCount : 0;
+	}
+
+	const SymbolIndexEntry*
+	getEntry(size_t i)
+	{
+		return &m_entryTable[i];
+	}
+
+	bool
+	isRebuilt()
+	{
+		return m_isRebuilt;
+	}
+
+	sl::StringRef
+	getName(const SymbolIndexEntry* entry)
+	{
+		return sl::StringRef(m_data + entry->m_nameOffset, entry->m_nameLength);
+	}
+
+	sl::StringRef
+	getId(const SymbolIndexEntry* entry)
+	{
+		return sl::StringRef(m_data + entry->m_idOffset, entry->m_idLength);
+	}
+
+	sl::StringRef
+	getKind(const SymbolIndexEntry* entry)
+	{
+		return sl::StringRef(m_data + entry->m_kindOffset, entry->m_kindLength);
+	}
+
+	const SymbolIndexEntry*
+	getCompound(const SymbolIndexEntry* entry)
+	{
+		return entry->m_compoundIdx != (uint32_t)-1 ? &m_entryTable[entry->m_compoundIdx] : NULL;
+	}
+
+	// loads the index from the cache file, or (re)builds it from the source
+	// XML and writes it back to the cache file if it's missing or stale
+
+	bool
+	open(
+		const sl::StringRef& inputFileName,
+		const sl::StringRef& cacheFileName
+		);
+
+	void
+	close();
+
+	// the cache file is mapped (where possible) rather than read
+
+	bool
+	load(const sl::StringRef& fileName);
+
+	bool
+	save(const sl::StringRef& fileName);
+
+	bool
+	build(
+		IndexSkeleton* skeleton,
+		uint64_t sourceSize,
+		uint64_t sourceTime
+		);
+
+	// appends indices of matching entries to the array (at most maxCount); fuzzy
+	// matches are ordered by relevance, others -- by qualified name
+
+	void
+	find(
+		sl::Array<size_t>* resultArray,
+		const sl::StringRef& pattern,
+		SymbolMatchKind matchKind,
+		size_t maxCount
+		);
+
+protected:
+	bool
+	attachData(const sl::StringRef& fileName);
+
+	size_t
+	findNameLowerBound(const sl::StringRef& name);
+
+	size_t
+	findIdLowerBound(const sl::StringRef& id);
+
+	void
+	findPrefix(
+		sl::Array<size_t>* resultArray,
+		const sl::StringRef& prefix,
+		bool isExact,
+		size_t maxCount
+		);
+
+	void
+	findFuzzy(
+		sl::Array<size_t>* resultArray,
+		const sl::StringRef& pattern,
+		size_t maxCount
+		);
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+// the cache file used when none is specified: <input>.symbols
+
+sl::String
+getDefaultSymbolIndexFileName(const sl::StringRef& inputFileName);
+
+//..............................................................................
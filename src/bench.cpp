@@ -0,0 +1,170 @@
+//..............................................................................
+//
+//  This file is part of the Doxyrest toolkit.
+//
+//  Doxyrest is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/doxyrest/license.txt
+//
+//..............................................................................
+
+// measures the in-process path of libdoxyrest: the Lua state and the model are
+// created once, then the model is rendered into memory over and over again --
+// compare with the per-run cost of spawning doxyrest (e.g. with
+// samples/sh/bench-lua-backends.sh)
+//
+// usage: doxyrest-bench <run-count> <doxyrest-options>...
+
+#include "pch.h"
+#include "Session.h"
+
+#include <chrono>
+
+//..............................................................................
+
+class Stopwatch
+{
+protected:
+	std::chrono::steady_clock::time_point m_start;
+
+public:
+	Stopwatch()
+	{
+		restart();
+	}
+
+	void
+	restart()
+	{
+		m_start = std::chrono::steady_clock::now();
+	}
+
+	double
+	getElapsedMs()
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start).count();
+	}
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+int
+runBench(
+	size_t runCount,
+	CmdLine* cmdLine
+	)
+{
+	bool result;
+
+	Session session;
+	Stopwatch stopwatch;
+
+	result = session.configure(cmdLine);
+	if (!result)
+		return -1;
+
+	double configureTime = stopwatch.getElapsedMs();
+
+	sl::String inputFileName = !cmdLine->m_inputFileName.isEmpty() ?
+		cmdLine->m_inputFileName :
+		session.getGenerator()->getConfigValue("INPUT_FILE");
+
+	stopwatch.restart();
+	result = session.loadModel(inputFileName, cmdLine->m_threadCount);
+	if (!result)
+		return -1;
+
+	double loadTime = stopwatch.getElapsedMs();
+
+	printf(
+		"configure (lua startup): %10.1f ms\n"
+		"load model:              %10.1f ms\n",
+		configureTime,
+		loadTime
+		);
+
+	MemoryOutputSink sink;
+	double minRenderTime = 0;
+	double totalRenderTime = 0;
+
+	for (size_t i = 0; i < runCount; i++)
+	{
+		sink.clear();
+
+		stopwatch.restart();
+		result = session.render(&sink);
+		if (!result)
+			return -1;
+
+		double renderTime = stopwatch.getElapsedMs();
+		totalRenderTime += renderTime;
+		if (!i || renderTime < minRenderTime)
+			minRenderTime = renderTime;
+
+		printf("render #%-16d %10.1f ms\n", (int)i + 1, renderTime);
+	}
+
+	printf(
+		"render (min):            %10.1f ms\n"
+		"render (avg):            %10.1f ms\n"
+		"files per render:        %10d\n",
+		minRenderTime,
+		runCount ? totalRenderTime / runCount : 0,
+		(int)sink.getFileList().getCount()
+		);
+
+	return 0;
+}
+
+//..............................................................................
+
+#if (_AXL_OS_WIN)
+int
+wmain(
+	int argc,
+	wchar_t* argv[]
+	)
+#else
+int
+main(
+	int argc,
+	char* argv[]
+	)
+#endif
+{
+	if (argc < 2)
+	{
+		printf("Usage: doxyrest-bench <run-count> <doxyrest-options>...\n");
+		return -1;
+	}
+
+	Session::initialize();
+
+	size_t runCount =
+#if (_AXL_OS_WIN)
+		wcstoul(argv[1], NULL, 10);
+#else
+		strtoul(argv[1], NULL, 10);
+#endif
+
+	CmdLine cmdLine;
+	CmdLineParser parser(&cmdLine);
+
+	// the run count takes the place of the program name for the parser
+
+	bool result = parser.parse(argc - 1, argv + 1);
+	if (!result)
+	{
+		printf("error parsing command line: %s\n", err::getLastErrorDescription().sz());
+		return -1;
+	}
+
+	int exitCode = runBench(runCount ? runCount : 1, &cmdLine);
+	if (exitCode)
+		fprintf(stderr, "error: %s\n", err::getLastErrorDescription().sz());
+
+	return exitCode;
+}
+
+//..............................................................................
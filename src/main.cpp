@@ -11,11 +11,17 @@
 
 #include "pch.h"
 #include "CmdLine.h"
-#include "DoxyXmlParser.h"
 #include "Module.h"
-#include "Generator.h"
+#include "Session.h"
+#include "BatchRunner.h"
+#include "IndexSkeleton.h"
+#include "SymbolIndex.h"
+#include "SearchIndex.h"
+#include "FileSystemWatcher.h"
 #include "version.h"
 
+#include <thread>
+
 #define _PRINT_MODULE 0
 
 //..............................................................................
@@ -24,12 +30,17 @@ void
 printVersion()
 {
 	printf(
-		"doxyrest v%d.%d.%d (%s%s)\n",
+		"doxyrest v%d.%d.%d (%s%s, %s)\n",
 		VERSION_MAJOR,
 		VERSION_MINOR,
 		VERSION_REVISION,
 		AXL_CPU_STRING,
-		AXL_DEBUG_SUFFIX
+		AXL_DEBUG_SUFFIX,
+#if (_DOXYREST_LUAJIT)
+		LUAJIT_VERSION
+#else
+		LUA_RELEASE
+#endif
 		);
 }
 
@@ -39,7 +50,11 @@ printUsage()
 	printVersion();
 
 	sl::String helpString = CmdLineSwitchTable::getHelpString();
-	printf("Usage: doxyrest <doxygen-index.xml> <options>...\n%s", helpString.sz());
+	printf(
+		"Usage: doxyrest <doxygen-index.xml> <options>...\n"
+		"       doxyrest query <doxygen-index.xml> <pattern> <options>...\n%s",
+		helpString.sz()
+		);
 }
 
 #if _PRINT_MODULE
@@ -407,26 +422,242 @@ printNamespaceContents(NamespaceContents* nspace)
 }
 #endif
 
-int
-run(CmdLine* cmdLine)
+// object counts and bytes by type, side by side for both phases
+
+void
+printModelMemoryStats(
+	ModelMemoryStats* parseStats,
+	ModelMemoryStats* buildStats
+	)
 {
-	bool result;
+	if (parseStats->isEmpty())
+		return;
 
-	Module module;
-	GlobalNamespace globalNamespace;
-	DoxyXmlParser parser;
-	Generator generator;
+	printf(
+		"%-24s %10s %12s %10s %12s\n",
+		"model memory:",
+		"parsed",
+		"bytes",
+		"built",
+		"bytes"
+		);
 
-	result = generator.create(cmdLine);
-	if (!result)
+	for (size_t i = 0; i < ModelObjectKind_Count; i++)
 	{
-		fprintf(stderr, "error: %s\n", err::getLastErrorDescription().sz());
-		return -1;
+		const MemoryStatsEntry& parseEntry = parseStats->getEntry((ModelObjectKind)i);
+		const MemoryStatsEntry& buildEntry = buildStats->getEntry((ModelObjectKind)i);
+
+		if (!parseEntry.m_count && !buildEntry.m_count)
+			continue;
+
+		printf(
+			"  %-22s %10llu %12llu %10llu %12llu\n",
+			getModelObjectKindString((ModelObjectKind)i),
+			(unsigned long long)parseEntry.m_count,
+			(unsigned long long)parseEntry.m_size,
+			(unsigned long long)buildEntry.m_count,
+			(unsigned long long)buildEntry.m_size
+			);
 	}
 
+	printf(
+		"  %-22s %10s %12llu %10s %12llu\n",
+		"total",
+		"",
+		(unsigned long long)parseStats->getTotalSize(),
+		"",
+		(unsigned long long)buildStats->getTotalSize()
+		);
+}
+
+void
+printLuaMemoryStats(LuaMemoryStats* stats)
+{
+	if (stats->isEmpty())
+		return;
+
+	printf(
+		"%-24s %10s %12s %10s %12s\n",
+		"lua memory (estimate):",
+		"tables",
+		"bytes",
+		"strings",
+		"bytes"
+		);
+
+	for (size_t i = 0; i < LuaObjectKind_Count; i++)
+	{
+		const MemoryStatsEntry& tableEntry = stats->getTableEntry((LuaObjectKind)i);
+		const MemoryStatsEntry& stringEntry = stats->getStringEntry((LuaObjectKind)i);
+
+		if (!tableEntry.m_count && !stringEntry.m_count)
+			continue;
+
+		printf(
+			"  %-22s %10llu %12llu %10llu %12llu\n",
+			getLuaObjectKindString((LuaObjectKind)i),
+			(unsigned long long)tableEntry.m_count,
+			(unsigned long long)tableEntry.m_size,
+			(unsigned long long)stringEntry.m_count,
+			(unsigned long long)stringEntry.m_size
+			);
+	}
+
+	printf(
+		"  %-22s %10s %12s %10s %12llu\n",
+		"total",
+		"",
+		"",
+		"",
+		(unsigned long long)stats->getTotalSize()
+		);
+}
+
+void
+printStats(
+	Module* module,
+	Generator* generator
+	)
+{
+	const StringInternStats& internStats = module->m_internStats;
+
+	printf(
+		"string interning:\n"
+		"  unique strings:  %llu\n"
+		"  requests:        %llu\n"
+		"  hits:            %llu\n"
+		"  bytes saved:     %llu\n",
+
+		(unsigned long long)module->m_internTable.getCount(),
+		(unsigned long long)internStats.m_requestCount,
+		(unsigned long long)internStats.m_hitCount,
+		(unsigned long long)internStats.m_savedSize
+		);
+
+	printf(
+		"cross-reference handles:\n"
+		"  handles:         %llu\n",
+
+		(unsigned long long)module->m_handleTable.getCount()
+		);
+
+	printf(
+		"xml skipping:\n"
+		"  bytes skipped:   %llu\n",
+
+		(unsigned long long)module->m_skippedXmlSize
+		);
+
+	printf(
+		"group members:\n"
+		"  id refs only:    %llu\n",
+
+		(unsigned long long)module->m_groupMemberRefCount
+		);
+
+	if (module->m_deferredDescriptionCount)
+		printf(
+			"deferred descriptions:\n"
+			"  recorded:        %llu\n"
+			"  parsed:          %llu\n",
+
+			(unsigned long long)module->m_deferredDescriptionCount,
+			(unsigned long long)module->m_loadedDescriptionCount
+			);
+
+	if (module->m_isStreaming)
+		printf(
+			"streaming:\n"
+			"  unloaded:        %llu\n"
+			"  max per file:    %llu\n",
+
+			(unsigned long long)module->m_unloadedDescriptionCount,
+			(unsigned long long)module->m_maxLoadedDescriptionCount
+			);
+
+	const sl::Array<LuaHeapSample>& luaHeapSampleArray = generator->getLuaHeapSampleArray();
+	size_t count = luaHeapSampleArray.getCount();
+	if (count)
+	{
+		printf("lua heap:\n");
+
+		for (size_t i = 0; i < count; i++)
+			printf(
+				"  after %s: %llu\n",
+				luaHeapSampleArray[i].m_phase,
+				(unsigned long long)luaHeapSampleArray[i].m_size
+				);
+
+		if (generator->getPeakLuaHeapSize())
+			printf("  peak between files: %llu\n", (unsigned long long)generator->getPeakLuaHeapSize());
+	}
+
+	printLuaMemoryStats(generator->getLuaMemoryStats());
+
+	SearchIndex* searchIndex = generator->getSearchIndex();
+	if (searchIndex->getEntryCount())
+		printf(
+			"search index:\n"
+			"  entries:         %llu\n"
+			"  shards:          %llu\n"
+			"  bytes:           %llu\n"
+			"  build time, ms:  %.1f\n",
+
+			(unsigned long long)searchIndex->getEntryCount(),
+			(unsigned long long)searchIndex->getShardCount(),
+			(unsigned long long)searchIndex->getTotalSize(),
+			generator->getSearchIndexBuildTime()
+			);
+
+	OutputSink* outputSink = generator->getOutputSink();
+
+	printf(
+		"output:\n"
+		"  files:           %llu\n"
+		"  bytes:           %llu\n",
+
+		(unsigned long long)outputSink->getFileCount(),
+		(unsigned long long)outputSink->getTotalSize()
+		);
+
+	if (generator->getMode() != GeneratorMode_Normal)
+		printf(
+			"generation plan:\n"
+			"  planned files:   %llu\n"
+			"  rendered here:   %llu\n",
+
+			(unsigned long long)generator->getPlannedJobCount(),
+			(unsigned long long)generator->getRenderedJobCount()
+			);
+}
+
+void
+addWatchDir(
+	FileSystemWatcher* watcher,
+	const sl::StringRef& dir
+	)
+{
+	bool result = watcher->addDir(dir);
+	if (!result)
+		fprintf(stderr, "warning: %s\n", err::getLastErrorDescription().sz());
+}
+
+// loads the model and renders it with an already configured session
+
+int
+loadAndRender(
+	CmdLine* cmdLine,
+	Session* session,
+	FileSystemWatcher* watcher = NULL // only in watch mode
+	)
+{
+	bool result;
+
+	Generator* generator = session->getGenerator();
+
 	sl::String inputFileName = !cmdLine->m_inputFileName.isEmpty() ?
 		cmdLine->m_inputFileName :
-		generator.getConfigValue("INPUT_FILE");
+		generator->getConfigValue("INPUT_FILE");
 
 	if (inputFileName.isEmpty())
 	{
@@ -434,14 +665,14 @@ run(CmdLine* cmdLine)
 		return 0;
 	}
 
-	sl::String globalAuxCompoundId = generator.getConfigValue("GLOBAL_AUX_COMPOUND_ID");
-	sl::String footnoteMemberPrefix = generator.getConfigValue("FOOTNOTE_MEMBER_PREFIX");
+	size_t generatorCount = session->getGeneratorCount();
+
+	if (watcher)
+		addWatchDir(watcher, io::getDir(inputFileName));
 
 	result =
-		parser.parseFile(&module, inputFileName) &&
-		globalNamespace.build(&module, globalAuxCompoundId, footnoteMemberPrefix) &&
-		generator.luaExport(&module, &globalNamespace) &&
-		generator.generate();
+		session->loadModel(inputFileName, cmdLine->m_threadCount) &&
+		session->render();
 
 	if (!result)
 	{
@@ -449,15 +680,320 @@ run(CmdLine* cmdLine)
 		return -1;
 	}
 
+	if (cmdLine->m_flags & CmdLineFlag_Stats)
+		printModelMemoryStats(session->getParseMemoryStats(), session->getBuildMemoryStats());
+
+	for (size_t i = 0; i < generatorCount; i++)
+	{
+		generator = session->getGenerator(i);
+
+		if (generatorCount > 1 && ((cmdLine->m_flags & CmdLineFlag_Stats) || watcher))
+			printf("%s:\n", generator->getOutputFileName().sz());
+
+		if (cmdLine->m_flags & CmdLineFlag_Stats)
+			printStats(session->getModule(), generator);
+
+		if (watcher)
+		{
+			OutputSink* outputSink = generator->getOutputSink();
+			size_t unchangedCount = generator->getDirOutputSink()->getUnchangedFileCount();
+
+			printf(
+				"%d file(s) generated, %d updated\n",
+				(int)outputSink->getFileCount(),
+				(int)(outputSink->getFileCount() - unchangedCount)
+				);
+		}
+	}
+
 #if _PRINT_MODULE
 	printf("namespace :: {\n");
-	printNamespaceContents(&globalNamespace);
+	printNamespaceContents(session->getGlobalNamespace());
 	printf("} // namespace :: {\n");
 #endif
 
 	return 0;
 }
 
+int
+run(CmdLine* cmdLine)
+{
+	Session session;
+	bool result = session.configure(cmdLine);
+	if (!result)
+	{
+		fprintf(stderr, "error: %s\n", err::getLastErrorDescription().sz());
+		return -1;
+	}
+
+	return loadAndRender(cmdLine, &session);
+}
+
+// the session -- and with it, the Lua state with the configuration and the
+// frame directories -- is kept between updates; it is only re-created when
+// something changes in the directories of configuration files or frames.
+// otherwise, an update reloads the model into the same session:
+//
+//   - all of the XML is re-parsed, unchanged compounds, too:
+//     GlobalNamespace::build modifies the parsed compounds and members in
+//     place (names are unqualified, footnote members renamed, group and
+//     namespace links assigned, member compounds created), so a parsed module
+//     can't be built a second time;
+//   - all of the files are re-rendered; before the new model is exported, the
+//     Lua globals added or replaced by frames (g_itemFileNameMap, include
+//     guards, etc) are reset to what they were after configuration.
+//
+// unchanged files are not re-written
+
+int
+watch(CmdLine* cmdLine)
+{
+	enum
+	{
+		SettleTime = 300, // ms
+	};
+
+	FileSystemWatcher watcher;
+	Session* session = NULL;
+	bool isReconfigureNeeded = true;
+
+	for (;;)
+	{
+		bool result = watcher.open();
+		if (!result)
+		{
+			fprintf(stderr, "error: %s\n", err::getLastErrorDescription().sz());
+			break;
+		}
+
+		// add what we know upfront, so we can recover from config errors
+
+		sl::ConstBoxIterator<sl::String> it = cmdLine->m_configFileNameList.getHead();
+		for (; it; it++)
+			addWatchDir(&watcher, io::getDir(*it));
+
+		it = cmdLine->m_frameDirList.getHead();
+		for (; it; it++)
+			addWatchDir(&watcher, *it);
+
+		if (isReconfigureNeeded)
+		{
+			if (session)
+				AXL_MEM_DELETE(session);
+
+			session = AXL_MEM_NEW(Session);
+			result = session->configure(cmdLine);
+			if (!result)
+			{
+				fprintf(stderr, "error: %s\n", err::getLastErrorDescription().sz());
+				AXL_MEM_DELETE(session);
+				session = NULL;
+			}
+		}
+
+		if (session)
+		{
+			size_t generatorCount = session->getGeneratorCount();
+			for (size_t i = 0; i < generatorCount; i++)
+			{
+				it = session->getGenerator(i)->getFrameDirList().getHead();
+				for (; it; it++)
+					addWatchDir(&watcher, *it);
+			}
+		}
+
+		// changes in any of these directories require a new session
+
+		sl::BoxList<sl::String> configDirList;
+		it = watcher.getDirList().getHead();
+		for (; it; it++)
+			configDirList.insertTail(*it);
+
+		if (session)
+			loadAndRender(cmdLine, session, &watcher); // errors are reported, but we keep watching
+
+		if (watcher.getDirList().isEmpty())
+		{
+			fprintf(stderr, "error: nothing to watch\n");
+			break;
+		}
+
+		printf("watching for changes (press Ctrl+C to stop)...\n");
+
+		sl::String fileName;
+		sl::BoxList<sl::String> changedDirList;
+		result = watcher.wait(SettleTime, &fileName, &changedDirList);
+		if (!result)
+		{
+			fprintf(stderr, "error: %s\n", err::getLastErrorDescription().sz());
+			break;
+		}
+
+		isReconfigureNeeded = !session;
+
+		sl::ConstBoxIterator<sl::String> changedIt = changedDirList.getHead();
+		for (; changedIt && !isReconfigureNeeded; changedIt++)
+			for (it = configDirList.getHead(); it; it++)
+				if (*it == *changedIt)
+				{
+					isReconfigureNeeded = true;
+					break;
+				}
+
+		printf(
+			"'%s' changed, %s...\n",
+			fileName.sz(),
+			isReconfigureNeeded ? "reconfiguring and regenerating" : "regenerating"
+			);
+	}
+
+	if (session)
+		AXL_MEM_DELETE(session);
+
+	return -1;
+}
+
+// tab-separated <kind> <id> <qualified-name>, compounds first
+
+int
+listSymbols(CmdLine* cmdLine)
+{
+	if (cmdLine->m_inputFileName.isEmpty())
+	{
+		fprintf(stderr, "error: --list-symbols requires an input master XML file\n");
+		return -1;
+	}
+
+	IndexSkeleton skeleton;
+	bool result = skeleton.loadInput(cmdLine->m_inputFileName);
+	if (!result)
+	{
+		fprintf(stderr, "error: %s\n", err::getLastErrorDescription().sz());
+		return -1;
+	}
+
+	sl::ConstIterator<IndexCompound> compoundIt = skeleton.getCompoundList().getHead();
+	for (; compoundIt; compoundIt++)
+		printf(
+			"%s\t%s\t%s\n",
+			getCompoundKindString(compoundIt->m_compoundKind),
+			compoundIt->m_id.sz(),
+			compoundIt->m_name.sz()
+			);
+
+	sl::ConstIterator<IndexMember> memberIt = skeleton.getMemberList().getHead();
+	for (; memberIt; memberIt++)
+		printf(
+			"%s\t%s\t%s\n",
+			getMemberKindString(memberIt->m_memberKind),
+			memberIt->m_id.sz(),
+			memberIt->getQualifiedName().sz()
+			);
+
+	return 0;
+}
+
+// one JSON object per query; members point to the XML file of the compound
+// they are documented in
+
+int
+query(CmdLine* cmdLine)
+{
+	sl::String cacheFileName = !cmdLine->m_symbolIndexFileName.isEmpty() ?
+		cmdLine->m_symbolIndexFileName :
+		getDefaultSymbolIndexFileName(cmdLine->m_inputFileName);
+
+	SymbolIndex index;
+	bool result = index.open(cmdLine->m_inputFileName, cacheFileName);
+	if (!result)
+	{
+		fprintf(stderr, "error: %s\n", err::getLastErrorDescription().sz());
+		return -1;
+	}
+
+	sl::Array<size_t> resultArray;
+	index.find(&resultArray, cmdLine->m_queryString, cmdLine->m_queryMatchKind, cmdLine->m_queryLimit);
+
+	sl::String json = "{\"query\":";
+	appendJsonString(&json, cmdLine->m_queryString);
+	json.appendFormat(
+		",\"match\":\"%s\",\"index\":\"%s\",\"symbolCount\":%d,\"results\":[",
+		getSymbolMatchKindString(cmdLine->m_queryMatchKind),
+		index.isRebuilt() ? "built" : "cached",
+		(int)index.getEntryCount()
+		);
+
+	size_t count = resultArray.getCount();
+	for (size_t i = 0; i < count; i++)
+	{
+		const SymbolIndexEntry* entry = index.getEntry(resultArray[i]);
+		const SymbolIndexEntry* compound = index.getCompound(entry);
+		const SymbolIndexEntry* fileEntry = entry->m_isMember ? compound : entry;
+
+		json += i ? ",\n{\"name\":" : "\n{\"name\":";
+		appendJsonString(&json, index.getName(entry));
+		json += ",\"id\":";
+		appendJsonString(&json, index.getId(entry));
+		json += ",\"kind\":";
+		appendJsonString(&json, index.getKind(entry));
+
+		if (compound)
+		{
+			json += ",\"compound\":";
+			appendJsonString(&json, index.getName(compound));
+			json += ",\"compoundId\":";
+			appendJsonString(&json, index.getId(compound));
+		}
+
+		// the generated .rst page is chosen by the frames, so it's not known
+		// without running them -- only the XML source is reported
+
+		if (fileEntry)
+		{
+			json += ",\"xmlFile\":";
+			appendJsonString(&json, index.getId(fileEntry) + ".xml");
+		}
+
+		json += '}';
+	}
+
+	json += "\n]}\n";
+	printf("%s", json.sz());
+	return 0;
+}
+
+// all projects share one pool: unlike separate doxyrest processes, idle
+// workers immediately pick up the next project, whichever library it is
+
+int
+runBatch(CmdLine* cmdLine)
+{
+	BatchRunner runner;
+	bool result = runner.readProjectList(cmdLine->m_batchFileName);
+	if (!result)
+	{
+		fprintf(stderr, "error: %s\n", err::getLastErrorDescription().sz());
+		return -1;
+	}
+
+	size_t threadCount = (cmdLine->m_flags & CmdLineFlag_Jobs) ?
+		cmdLine->m_threadCount :
+		std::thread::hardware_concurrency();
+
+	if (!threadCount)
+		threadCount = 1;
+
+	result = runner.run(cmdLine, threadCount);
+
+	printf(
+		"%d project(s) processed, %d failed\n",
+		(int)runner.getProjectList().getCount(),
+		(int)runner.getFailedProjectCount()
+		);
+
+	return result ? 0 : -1;
+}
+
 //..............................................................................
 
 #if (_AXL_OS_WIN)
@@ -480,9 +1016,7 @@ main(
 	setvbuf(stdout, NULL, _IOLBF, 1024);
 #endif
 
-	g::getModule()->setTag("doxyrest");
-	xml::registerExpatErrorProvider();
-	lex::registerParseErrorProvider();
+	Session::initialize();
 
 	CmdLine cmdLine;
 	CmdLineParser parser(&cmdLine);
@@ -500,6 +1034,14 @@ main(
 		printUsage();
 	else if (cmdLine.m_flags & CmdLineFlag_Version)
 		printVersion();
+	else if (cmdLine.m_flags & CmdLineFlag_Symbols)
+		result = listSymbols(&cmdLine);
+	else if (cmdLine.m_flags & CmdLineFlag_Query)
+		result = query(&cmdLine);
+	else if (!cmdLine.m_batchFileName.isEmpty())
+		result = runBatch(&cmdLine);
+	else if (cmdLine.m_flags & CmdLineFlag_Watch)
+		result = watch(&cmdLine);
 	else
 		result = run(&cmdLine);
 
@@ -16,5 +16,15 @@
 #include "axl_io_FilePathUtils.h"
 #include "axl_st_LuaStringTemplate.h"
 #include "axl_xml_ExpatParser.h"
+#include "axl_io_File.h"
+#include "axl_zip_ZipReader.h"
+#include "axl_sys_Thread.h"
+#include "axl_sys_Lock.h"
+
+#if (_DOXYREST_LUAJIT)
+#	include <luajit.h>
+#endif
+
+#include <algorithm>
 
 using namespace axl;